@@ -0,0 +1,70 @@
+// Measures the dispatch of window events to many listeners. Run it with
+// `flutter test benchmark/dispatch_benchmark.dart`.
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:window_manager/window_manager.dart';
+
+void main() {
+  const MethodChannel channel = MethodChannel('window_manager');
+
+  TestWidgetsFlutterBinding.ensureInitialized();
+
+  test('dispatches events to hundreds of listeners', () async {
+    const int listenerCount = 500;
+    const int eventCount = 1000;
+    final List<_CountingListener> allEventsListeners = [
+      for (int i = 0; i < listenerCount; i++) _CountingListener(),
+    ];
+    final List<_CountingListener> moveListeners = [
+      for (int i = 0; i < listenerCount; i++) _CountingListener(),
+    ];
+    for (final listener in allEventsListeners) {
+      windowManager.addListener(listener);
+    }
+    for (final listener in moveListeners) {
+      windowManager.addListener(listener, events: {kWindowEventMove});
+    }
+
+    Future<void> sendEvent(String eventName) async {
+      await TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .handlePlatformMessage(
+        channel.name,
+        channel.codec.encodeMethodCall(
+          MethodCall('onEvent', {
+            'eventName': eventName,
+            'eventId': kWindowEvents.indexOf(eventName),
+          }),
+        ),
+        (_) {},
+      );
+    }
+
+    final Stopwatch stopwatch = Stopwatch()..start();
+    for (int i = 0; i < eventCount; i++) {
+      await sendEvent(kWindowEventMove);
+    }
+    stopwatch.stop();
+
+    // ignore: avoid_print
+    print(
+      'Dispatched $eventCount events to ${2 * listenerCount} listeners in '
+      '${stopwatch.elapsedMicroseconds / eventCount} us per event',
+    );
+    expect(
+      [...allEventsListeners, ...moveListeners]
+          .every((e) => e.moves == eventCount),
+      isTrue,
+    );
+
+    for (final listener in [...allEventsListeners, ...moveListeners]) {
+      windowManager.removeListener(listener);
+    }
+  });
+}
+
+class _CountingListener with WindowListener {
+  int moves = 0;
+
+  @override
+  void onWindowMove() => moves++;
+}
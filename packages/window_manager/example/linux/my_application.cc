@@ -1,6 +1,9 @@
 #include "my_application.h"
 
 #include <flutter_linux/flutter_linux.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 #ifdef GDK_WINDOWING_X11
 #include <gdk/gdkx.h>
 #endif
@@ -14,6 +17,104 @@ struct _MyApplication {
 
 G_DEFINE_TYPE(MyApplication, my_application, GTK_TYPE_APPLICATION)
 
+// Creates and destroys engines in the same window, as add-to-app hosts do,
+// and reports the resident memory, the number of signal handlers left on
+// the window and the average time spent registering plugins. Enabled by
+// setting WINDOW_MANAGER_REGISTRATION_BENCHMARK to the number of engines to
+// create.
+typedef struct {
+  GtkWindow* window;
+  FlDartProject* project;
+  FlView* view;
+  gint engines;
+  gint engine_count;
+  // In microseconds.
+  gint64 registration_time;
+} RegistrationBenchmark;
+
+static void registration_benchmark_free(gpointer data) {
+  RegistrationBenchmark* benchmark = static_cast<RegistrationBenchmark*>(data);
+  g_object_unref(benchmark->project);
+  g_free(benchmark);
+}
+
+static glong get_resident_kb() {
+  g_autofree gchar* statm = nullptr;
+  if (!g_file_get_contents("/proc/self/statm", &statm, nullptr, nullptr))
+    return -1;
+
+  glong size = 0, resident = 0;
+  sscanf(statm, "%ld %ld", &size, &resident);
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// Counts the signal handlers connected to `instance`. Each handler found is
+// blocked so that the next search skips it, and unblocked afterwards.
+static guint count_signal_handlers(gpointer instance) {
+  g_autoptr(GArray) handler_ids = g_array_new(false, false, sizeof(gulong));
+  gulong handler_id;
+  while ((handler_id = g_signal_handler_find(
+              instance, G_SIGNAL_MATCH_UNBLOCKED, 0, 0, nullptr, nullptr,
+              nullptr)) != 0) {
+    g_signal_handler_block(instance, handler_id);
+    g_array_append_val(handler_ids, handler_id);
+  }
+  for (guint i = 0; i < handler_ids->len; i++) {
+    g_signal_handler_unblock(instance,
+                             g_array_index(handler_ids, gulong, i));
+  }
+  return handler_ids->len;
+}
+
+static void print_registration_benchmark(RegistrationBenchmark* benchmark) {
+  g_print("%d engines: %ld kB resident, %u handlers on the window, "
+          "%" G_GINT64_FORMAT " us per registration\n",
+          benchmark->engine_count, get_resident_kb(),
+          count_signal_handlers(benchmark->window),
+          benchmark->engine_count > 0
+              ? benchmark->registration_time / benchmark->engine_count
+              : 0);
+}
+
+static gboolean registration_benchmark_step(gpointer data) {
+  RegistrationBenchmark* benchmark = static_cast<RegistrationBenchmark*>(data);
+  if (benchmark->view != nullptr) {
+    gtk_widget_destroy(GTK_WIDGET(benchmark->view));
+    benchmark->view = nullptr;
+    benchmark->engine_count++;
+    if (benchmark->engine_count % 100 == 0 ||
+        benchmark->engine_count == benchmark->engines) {
+      print_registration_benchmark(benchmark);
+    }
+    if (benchmark->engine_count == benchmark->engines) {
+      gtk_widget_destroy(GTK_WIDGET(benchmark->window));
+      return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+  }
+
+  benchmark->view = fl_view_new(benchmark->project);
+  gtk_widget_show(GTK_WIDGET(benchmark->view));
+  gtk_container_add(GTK_CONTAINER(benchmark->window),
+                    GTK_WIDGET(benchmark->view));
+  gint64 start_time = g_get_monotonic_time();
+  fl_register_plugins(FL_PLUGIN_REGISTRY(benchmark->view));
+  benchmark->registration_time += g_get_monotonic_time() - start_time;
+  return G_SOURCE_CONTINUE;
+}
+
+static void start_registration_benchmark(GtkWindow* window,
+                                         FlDartProject* project,
+                                         gint engines) {
+  RegistrationBenchmark* benchmark = g_new0(RegistrationBenchmark, 1);
+  benchmark->window = window;
+  benchmark->project = FL_DART_PROJECT(g_object_ref(project));
+  benchmark->engines = engines;
+  print_registration_benchmark(benchmark);
+  g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, registration_benchmark_step,
+                  benchmark, registration_benchmark_free);
+}
+
 // Implements GApplication::activate.
 static void my_application_activate(GApplication* application) {
   MyApplication* self = MY_APPLICATION(application);
@@ -54,6 +155,14 @@ static void my_application_activate(GApplication* application) {
   g_autoptr(FlDartProject) project = fl_dart_project_new();
   fl_dart_project_set_dart_entrypoint_arguments(project, self->dart_entrypoint_arguments);
 
+  const gchar* benchmark_engines =
+      g_getenv("WINDOW_MANAGER_REGISTRATION_BENCHMARK");
+  if (benchmark_engines != nullptr && atoi(benchmark_engines) > 0) {
+    gtk_widget_show(GTK_WIDGET(window));
+    start_registration_benchmark(window, project, atoi(benchmark_engines));
+    return;
+  }
+
   FlView* view = fl_view_new(project);
   gtk_widget_show(GTK_WIDGET(view));
   gtk_container_add(GTK_CONTAINER(window), GTK_WIDGET(view));
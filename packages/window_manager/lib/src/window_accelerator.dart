@@ -0,0 +1,37 @@
+enum WindowAcceleratorAction {
+  /// Only calls `WindowListener.onWindowAccelerator`.
+  notify,
+  hide,
+  show,
+  ungrab,
+}
+
+/// A shortcut matched natively while the keyboard is grabbed, even when the
+/// UI isolate is busy.
+class WindowAccelerator {
+  const WindowAccelerator(
+    this.accelerator, {
+    this.action = WindowAcceleratorAction.notify,
+    this.id,
+  });
+
+  /// The shortcut in the format of `gtk_accelerator_parse`, such as
+  /// `<Control><Alt>q`. It is matched like a GTK accelerator: CapsLock and
+  /// NumLock are ignored, and `<Control>exclam` matches Control+Shift+1.
+  final String accelerator;
+
+  /// What the plugin does when the shortcut is pressed.
+  final WindowAcceleratorAction action;
+
+  /// Passed to `WindowListener.onWindowAccelerator` when the shortcut is
+  /// pressed, unless null.
+  final String? id;
+
+  Map<String, dynamic> toJson() {
+    return {
+      'accelerator': accelerator,
+      'action': action.name,
+      'id': id,
+    }..removeWhere((key, value) => value == null);
+  }
+}
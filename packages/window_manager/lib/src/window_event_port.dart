@@ -0,0 +1,98 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:isolate';
+
+/// Window events in the order of the ids in the records posted by
+/// [WindowEventPort]. Must match `kWindowEvents` in the Linux plugin.
+const List<String> kWindowEvents = [
+  'close',
+  'focus',
+  'blur',
+  'maximize',
+  'unmaximize',
+  'minimize',
+  'restore',
+  'resize',
+  'resized',
+  'move',
+  'moved',
+  'enter-full-screen',
+  'leave-full-screen',
+  'docked',
+  'undocked',
+  'show',
+  'hide',
+  'pointer-motion',
+  'brightness-changed',
+  'transition-end',
+  'frame-metrics-changed',
+  'accelerator',
+  'main-loop-stall',
+];
+
+typedef _SetPostCObjectNative = Void Function(Pointer<Void> func);
+typedef _SetPostCObject = void Function(Pointer<Void> func);
+typedef _SubscribePortNative = Void Function(Int64 port, Uint32 eventMask);
+typedef _SubscribePort = void Function(int port, int eventMask);
+typedef _UnsubscribePortNative = Void Function(Int64 port);
+typedef _UnsubscribePort = void Function(int port);
+
+/// Delivers window events straight to a [SendPort], without going through
+/// the method channel of the root isolate.
+///
+/// Unlike `WindowManager`, this can be used from any isolate. Each message
+/// is a `List<int>` of `[eventId, timestamp]`, where `eventId` indexes
+/// [kWindowEvents] and `timestamp` is the native monotonic time in
+/// microseconds.
+///
+/// ```dart
+/// final receivePort = ReceivePort();
+/// WindowEventPort.subscribe(receivePort.sendPort, {'move', 'resize'});
+/// receivePort.listen((message) {
+///   final String eventName = kWindowEvents[(message as List)[0]];
+/// });
+/// ```
+///
+/// @platforms linux
+class WindowEventPort {
+  WindowEventPort._();
+
+  static final DynamicLibrary _library = DynamicLibrary.process();
+
+  static bool _isInitialized = false;
+
+  static void _ensureInitialized() {
+    if (!Platform.isLinux) {
+      throw UnsupportedError('WindowEventPort is only supported on Linux.');
+    }
+    if (_isInitialized) return;
+    _library.lookupFunction<_SetPostCObjectNative, _SetPostCObject>(
+      'window_manager_plugin_set_post_cobject',
+    )(NativeApi.postCObject.cast());
+    _isInitialized = true;
+  }
+
+  /// Posts the given `events` (all events if null) to `sendPort`.
+  ///
+  /// Subscribing the same `sendPort` again replaces its events.
+  static void subscribe(SendPort sendPort, [Set<String>? events]) {
+    _ensureInitialized();
+    int eventMask = 0;
+    for (int id = 0; id < kWindowEvents.length; id++) {
+      if (events == null || events.contains(kWindowEvents[id])) {
+        eventMask |= 1 << id;
+      }
+    }
+    _library.lookupFunction<_SubscribePortNative, _SubscribePort>(
+      'window_manager_plugin_subscribe_port',
+    )(sendPort.nativePort, eventMask);
+  }
+
+  /// Stops posting events to `sendPort`.
+  static void unsubscribe(SendPort sendPort) {
+    _ensureInitialized();
+    _library.lookupFunction<_UnsubscribePortNative, _UnsubscribePort>(
+      'window_manager_plugin_unsubscribe_port',
+    )(sendPort.nativePort);
+  }
+}
@@ -1,3 +1,7 @@
+import 'dart:ui';
+
+import 'package:flutter/painting.dart';
+
 abstract mixin class WindowListener {
   /// Emitted when the window is going to be closed.
   void onWindowClose() {}
@@ -33,7 +37,9 @@ abstract mixin class WindowListener {
 
   /// Emitted once when the window is moved to a new position.
   ///
-  /// @platforms macos,windows
+  /// On Linux, only emitted at the end of a drag with snapping enabled.
+  ///
+  /// @platforms linux,macos,windows
   void onWindowMoved() {}
 
   /// Emitted when the window enters a full-screen state.
@@ -42,6 +48,12 @@ abstract mixin class WindowListener {
   /// Emitted when the window leaves a full-screen state.
   void onWindowLeaveFullScreen() {}
 
+  /// Emitted after a full-screen transition requested by
+  /// `setFullScreen` completes, with the time it took.
+  ///
+  /// @platforms linux
+  void onWindowFullScreenTransition(bool isFullScreen, Duration duration) {}
+
   /// Emitted when the window entered a docked state.
   ///
   /// @platforms windows
@@ -52,6 +64,50 @@ abstract mixin class WindowListener {
   /// @platforms windows
   void onWindowUndocked() {}
 
+  /// Emitted when the desktop switches between a light and a dark color
+  /// scheme.
+  ///
+  /// @platforms linux
+  void onWindowBrightnessChanged(Brightness brightness) {}
+
+  /// Emitted once per frame while the pointer is locked, with the relative
+  /// motion accumulated since the previous frame.
+  ///
+  /// @platforms linux
+  void onWindowPointerMotion(Offset delta) {}
+
+  /// Emitted when a transition passed to `show` or `hide` is done, with
+  /// whether the window is now visible.
+  ///
+  /// @platforms linux
+  void onWindowTransitionEnd(bool visible) {}
+
+  /// Emitted when the title bar height, the frame drawn by the window manager
+  /// or the shadow drawn around client-side decorations changes size.
+  ///
+  /// @platforms linux
+  void onWindowFrameMetricsChanged(
+    int titleBarHeight,
+    EdgeInsets frameExtents,
+    EdgeInsets shadowExtents,
+  ) {}
+
+  /// Emitted when a `WindowAccelerator` with an id is pressed while the
+  /// keyboard is grabbed.
+  ///
+  /// @platforms linux
+  void onWindowAccelerator(String id) {}
+
+  /// Emitted when the main loop monitor sees a stall of `lag`, with the
+  /// longest native handler which ran during it, if any.
+  ///
+  /// @platforms linux
+  void onWindowMainLoopStall(
+    Duration lag,
+    String? handler,
+    Duration handlerDuration,
+  ) {}
+
   /// Emitted all events.
   void onWindowEvent(String eventName) {}
 }
@@ -1,5 +1,6 @@
 import 'dart:async';
 import 'dart:io';
+import 'dart:typed_data';
 import 'dart:ui';
 
 import 'package:flutter/foundation.dart';
@@ -9,8 +10,12 @@ import 'package:path/path.dart' as path;
 import 'package:window_manager/src/resize_edge.dart';
 import 'package:window_manager/src/title_bar_style.dart';
 import 'package:window_manager/src/utils/calc_window_position.dart';
+import 'package:window_manager/src/window_accelerator.dart';
+import 'package:window_manager/src/window_event_port.dart';
 import 'package:window_manager/src/window_listener.dart';
 import 'package:window_manager/src/window_options.dart';
+import 'package:window_manager/src/window_placement.dart';
+import 'package:window_manager/src/window_transition.dart';
 
 const kWindowEventClose = 'close';
 const kWindowEventFocus = 'focus';
@@ -25,12 +30,23 @@ const kWindowEventMove = 'move';
 const kWindowEventMoved = 'moved';
 const kWindowEventEnterFullScreen = 'enter-full-screen';
 const kWindowEventLeaveFullScreen = 'leave-full-screen';
+const kWindowEventPointerMotion = 'pointer-motion';
+const kWindowEventBrightnessChanged = 'brightness-changed';
+const kWindowEventTransitionEnd = 'transition-end';
+const kWindowEventFrameMetricsChanged = 'frame-metrics-changed';
+const kWindowEventAccelerator = 'accelerator';
+const kWindowEventMainLoopStall = 'main-loop-stall';
 
 const kWindowEventDocked = 'docked';
 const kWindowEventUndocked = 'undocked';
 
 enum DockSide { left, right }
 
+typedef _WindowEventHandler = void Function(
+  WindowListener listener,
+  Map<dynamic, dynamic>? eventData,
+);
+
 // WindowManager
 class WindowManager {
   WindowManager._() {
@@ -42,43 +58,126 @@ class WindowManager {
 
   final MethodChannel _channel = const MethodChannel('window_manager');
 
-  final ObserverList<WindowListener> _listeners =
-      ObserverList<WindowListener>();
+  // Listeners which receive every event, and listeners which only receive
+  // some events bucketed by event id. Buckets are replaced rather than
+  // modified, so that dispatch can iterate them without copying.
+  List<WindowListener> _allEventsListeners = const [];
+  final List<List<WindowListener>> _eventListeners =
+      List<List<WindowListener>>.filled(kWindowEvents.length, const []);
+  final Map<WindowListener, Set<int>?> _listeners = {};
+
+  static final Map<String, int> _eventIds = {
+    for (int id = 0; id < kWindowEvents.length; id++) kWindowEvents[id]: id,
+  };
+
+  static final Map<String, _WindowEventHandler> _eventHandlersByName = {
+    kWindowEventClose: (listener, _) => listener.onWindowClose(),
+    kWindowEventFocus: (listener, _) => listener.onWindowFocus(),
+    kWindowEventBlur: (listener, _) => listener.onWindowBlur(),
+    kWindowEventMaximize: (listener, _) => listener.onWindowMaximize(),
+    kWindowEventUnmaximize: (listener, _) => listener.onWindowUnmaximize(),
+    kWindowEventMinimize: (listener, _) => listener.onWindowMinimize(),
+    kWindowEventRestore: (listener, _) => listener.onWindowRestore(),
+    kWindowEventResize: (listener, _) => listener.onWindowResize(),
+    kWindowEventResized: (listener, _) => listener.onWindowResized(),
+    kWindowEventMove: (listener, _) => listener.onWindowMove(),
+    kWindowEventMoved: (listener, _) => listener.onWindowMoved(),
+    kWindowEventEnterFullScreen: (listener, eventData) {
+      listener.onWindowEnterFullScreen();
+      if (eventData?['duration'] != null) {
+        listener.onWindowFullScreenTransition(
+          true,
+          Duration(microseconds: eventData!['duration']),
+        );
+      }
+    },
+    kWindowEventLeaveFullScreen: (listener, eventData) {
+      listener.onWindowLeaveFullScreen();
+      if (eventData?['duration'] != null) {
+        listener.onWindowFullScreenTransition(
+          false,
+          Duration(microseconds: eventData!['duration']),
+        );
+      }
+    },
+    kWindowEventDocked: (listener, _) => listener.onWindowDocked(),
+    kWindowEventUndocked: (listener, _) => listener.onWindowUndocked(),
+    kWindowEventPointerMotion: (listener, eventData) {
+      listener.onWindowPointerMotion(
+        Offset(eventData!['dx'], eventData['dy']),
+      );
+    },
+    kWindowEventBrightnessChanged: (listener, eventData) {
+      listener.onWindowBrightnessChanged(
+        eventData!['brightness'] == 'dark' ? Brightness.dark : Brightness.light,
+      );
+    },
+    kWindowEventTransitionEnd: (listener, eventData) {
+      listener.onWindowTransitionEnd(eventData!['visible']);
+    },
+    kWindowEventFrameMetricsChanged: (listener, eventData) {
+      EdgeInsets toEdgeInsets(Map<dynamic, dynamic> extents) {
+        return EdgeInsets.fromLTRB(
+          extents['left'].toDouble(),
+          extents['top'].toDouble(),
+          extents['right'].toDouble(),
+          extents['bottom'].toDouble(),
+        );
+      }
+
+      listener.onWindowFrameMetricsChanged(
+        eventData!['titleBarHeight'],
+        toEdgeInsets(eventData['frameExtents']),
+        toEdgeInsets(eventData['shadowExtents']),
+      );
+    },
+    kWindowEventAccelerator: (listener, eventData) {
+      listener.onWindowAccelerator(eventData!['id']);
+    },
+    kWindowEventMainLoopStall: (listener, eventData) {
+      listener.onWindowMainLoopStall(
+        Duration(microseconds: eventData!['lag']),
+        eventData['handler'],
+        Duration(microseconds: eventData['handlerDuration']),
+      );
+    },
+  };
+
+  // Indexed by event id.
+  static final List<_WindowEventHandler?> _eventHandlers = [
+    for (final String eventName in kWindowEvents)
+      _eventHandlersByName[eventName],
+  ];
 
   Future<void> _methodCallHandler(MethodCall call) async {
-    for (final WindowListener listener in listeners) {
-      if (!_listeners.contains(listener)) {
-        return;
+    if (call.method != 'onEvent') throw UnimplementedError();
+
+    // The Linux plugin sends the index of the event in kWindowEvents, which
+    // saves looking the name up.
+    final int? eventId =
+        call.arguments['eventId'] ?? _eventIds[call.arguments['eventName']];
+    final String eventName =
+        eventId != null ? kWindowEvents[eventId] : call.arguments['eventName'];
+    final Map<dynamic, dynamic>? eventData = call.arguments['eventData'];
+    final _WindowEventHandler? handler =
+        eventId != null ? _eventHandlers[eventId] : null;
+
+    void dispatch(List<WindowListener> listeners) {
+      for (final WindowListener listener in listeners) {
+        // Skip listeners removed by a previous listener.
+        if (!_listeners.containsKey(listener)) continue;
+        listener.onWindowEvent(eventName);
+        handler?.call(listener, eventData);
       }
-
-      if (call.method != 'onEvent') throw UnimplementedError();
-
-      String eventName = call.arguments['eventName'];
-      listener.onWindowEvent(eventName);
-      Map<String, Function> funcMap = {
-        kWindowEventClose: listener.onWindowClose,
-        kWindowEventFocus: listener.onWindowFocus,
-        kWindowEventBlur: listener.onWindowBlur,
-        kWindowEventMaximize: listener.onWindowMaximize,
-        kWindowEventUnmaximize: listener.onWindowUnmaximize,
-        kWindowEventMinimize: listener.onWindowMinimize,
-        kWindowEventRestore: listener.onWindowRestore,
-        kWindowEventResize: listener.onWindowResize,
-        kWindowEventResized: listener.onWindowResized,
-        kWindowEventMove: listener.onWindowMove,
-        kWindowEventMoved: listener.onWindowMoved,
-        kWindowEventEnterFullScreen: listener.onWindowEnterFullScreen,
-        kWindowEventLeaveFullScreen: listener.onWindowLeaveFullScreen,
-        kWindowEventDocked: listener.onWindowDocked,
-        kWindowEventUndocked: listener.onWindowUndocked,
-      };
-      funcMap[eventName]?.call();
     }
+
+    dispatch(_allEventsListeners);
+    if (eventId != null) dispatch(_eventListeners[eventId]);
   }
 
   List<WindowListener> get listeners {
     final List<WindowListener> localListeners =
-        List<WindowListener>.from(_listeners);
+        List<WindowListener>.from(_listeners.keys);
     return localListeners;
   }
 
@@ -86,12 +185,38 @@ class WindowManager {
     return _listeners.isNotEmpty;
   }
 
-  void addListener(WindowListener listener) {
-    _listeners.add(listener);
+  /// Adds `listener`, for all events or only for the given `events`.
+  ///
+  /// Listeners for all events are called before listeners for some events.
+  void addListener(WindowListener listener, {Set<String>? events}) {
+    removeListener(listener);
+    if (events == null) {
+      _listeners[listener] = null;
+      _allEventsListeners = [..._allEventsListeners, listener];
+      return;
+    }
+    final Set<int> eventIds = {
+      for (final String eventName in events)
+        if (_eventIds[eventName] != null) _eventIds[eventName]!,
+    };
+    _listeners[listener] = eventIds;
+    for (final int id in eventIds) {
+      _eventListeners[id] = [..._eventListeners[id], listener];
+    }
   }
 
   void removeListener(WindowListener listener) {
-    _listeners.remove(listener);
+    if (!_listeners.containsKey(listener)) return;
+    final Set<int>? eventIds = _listeners.remove(listener);
+    if (eventIds == null) {
+      _allEventsListeners =
+          _allEventsListeners.where((e) => e != listener).toList();
+      return;
+    }
+    for (final int id in eventIds) {
+      _eventListeners[id] =
+          _eventListeners[id].where((e) => e != listener).toList();
+    }
   }
 
   double getDevicePixelRatio() {
@@ -206,20 +331,54 @@ class WindowManager {
   }
 
   /// Shows and gives focus to the window.
-  Future<void> show({bool inactive = false}) async {
+  ///
+  /// On Linux, `transition` is run natively once the first frame of the
+  /// window is ready, and [WindowListener.onWindowTransitionEnd] is called
+  /// when it is done.
+  Future<void> show({
+    bool inactive = false,
+    WindowTransition? transition,
+  }) async {
     bool isMinimized = await this.isMinimized();
     if (isMinimized) {
       await restore();
     }
     final Map<String, dynamic> arguments = {
       'inactive': inactive,
-    };
+      'transition': transition?.toJson(),
+    }..removeWhere((key, value) => value == null);
     await _channel.invokeMethod('show', arguments);
   }
 
   /// Hides the window.
-  Future<void> hide() async {
-    await _channel.invokeMethod('hide');
+  ///
+  /// On Linux, `transition` is run natively before the window is hidden,
+  /// and [WindowListener.onWindowTransitionEnd] is called when it is done.
+  Future<void> hide({WindowTransition? transition}) async {
+    final Map<String, dynamic> arguments = {
+      'transition': transition?.toJson(),
+    }..removeWhere((key, value) => value == null);
+    await _channel.invokeMethod('hide', arguments);
+  }
+
+  /// Sets whether the native window state drives the app lifecycle, so that
+  /// the framework stops producing frames while the window cannot be seen.
+  ///
+  /// The state is [AppLifecycleState.paused] while the window is hidden with
+  /// [hide], [AppLifecycleState.hidden] while it is minimized or on another
+  /// workspace, [AppLifecycleState.inactive] while it is not focused and
+  /// [AppLifecycleState.resumed] otherwise. Disabling it reports
+  /// [AppLifecycleState.resumed].
+  ///
+  /// While it is enabled, the state is sent after the engine reports its own
+  /// on every window state change, so it replaces the engine's state.
+  ///
+  /// @platforms linux
+  Future<void> setLifecycleReporting(bool isEnabled) async {
+    final Map<String, dynamic> arguments = {
+      'isEnabled': isEnabled,
+    };
+    await _channel.invokeMethod('setLifecycleReporting', arguments);
   }
 
   /// Returns `bool` - Whether the window is visible to the user.
@@ -266,10 +425,23 @@ class WindowManager {
   }
 
   /// Sets whether the window should be in fullscreen mode.
-  Future<void> setFullScreen(bool isFullScreen) async {
+  ///
+  /// On Linux, `monitor` selects the monitor (by its index on the display)
+  /// to go fullscreen on, `bypassCompositor` asks the X11 compositor to
+  /// unredirect the window while fullscreen, and `inhibitScreensaver`
+  /// prevents the session from going idle until fullscreen is left.
+  Future<void> setFullScreen(
+    bool isFullScreen, {
+    int? monitor,
+    bool bypassCompositor = false,
+    bool inhibitScreensaver = false,
+  }) async {
     final Map<String, dynamic> arguments = {
       'isFullScreen': isFullScreen,
-    };
+      'monitor': monitor,
+      'bypassCompositor': bypassCompositor,
+      'inhibitScreensaver': inhibitScreensaver,
+    }..removeWhere((key, value) => value == null);
     await _channel.invokeMethod('setFullScreen', arguments);
     // (Windows) Force refresh the app so it 's back to the correct size
     // (see GitHub issue #311)
@@ -325,6 +497,25 @@ class WindowManager {
     await _channel.invokeMethod('setAspectRatio', arguments);
   }
 
+  /// Makes the window resize in steps of `increment`, so that its size is
+  /// always `baseSize` plus a whole number of increments. Pass [Size.zero]
+  /// to resize freely again.
+  ///
+  /// @platforms linux,windows
+  Future<void> setResizeIncrements(
+    Size increment, {
+    Size baseSize = Size.zero,
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'devicePixelRatio': getDevicePixelRatio(),
+      'width': increment.width,
+      'height': increment.height,
+      'baseWidth': baseSize.width,
+      'baseHeight': baseSize.height,
+    };
+    await _channel.invokeMethod('setResizeIncrements', arguments);
+  }
+
   /// Sets the background color of the window.
   Future<void> setBackgroundColor(Color backgroundColor) async {
     final Map<String, dynamic> arguments = {
@@ -391,6 +582,35 @@ class WindowManager {
     await _channel.invokeMethod('setBounds', arguments);
   }
 
+  /// Returns the placement of the window, including its normal bounds while
+  /// it is maximized, minimized or full screen.
+  ///
+  /// @platforms linux,windows
+  Future<WindowPlacement> getPlacement() async {
+    final Map<String, dynamic> arguments = {
+      'devicePixelRatio': getDevicePixelRatio(),
+    };
+    final Map<dynamic, dynamic> resultData = await _channel.invokeMethod(
+      'getPlacement',
+      arguments,
+    );
+    return WindowPlacement.fromJson(resultData);
+  }
+
+  /// Restores the normal bounds, monitor, workspace and state of the window
+  /// at once, without showing the normal bounds first.
+  ///
+  /// On Windows, restoring the maximized or minimized state shows the window.
+  ///
+  /// @platforms linux,windows
+  Future<void> setPlacement(WindowPlacement placement) async {
+    final Map<String, dynamic> arguments = {
+      'devicePixelRatio': getDevicePixelRatio(),
+      ...placement.toJson(),
+    };
+    await _channel.invokeMethod('setPlacement', arguments);
+  }
+
   /// Returns `Size` - Contains the window's width and height.
   Future<Size> getSize() async {
     Rect bounds = await getBounds();
@@ -422,6 +642,8 @@ class WindowManager {
   }
 
   /// Sets the minimum size of window to `width` and `height`.
+  ///
+  /// The size includes the window frame, like the bounds of [getBounds].
   Future<void> setMinimumSize(Size size) async {
     final Map<String, dynamic> arguments = {
       'devicePixelRatio': getDevicePixelRatio(),
@@ -432,6 +654,8 @@ class WindowManager {
   }
 
   /// Sets the maximum size of window to `width` and `height`.
+  ///
+  /// The size includes the window frame, like the bounds of [getBounds].
   Future<void> setMaximumSize(Size size) async {
     final Map<String, dynamic> arguments = {
       'devicePixelRatio': getDevicePixelRatio(),
@@ -573,6 +797,28 @@ class WindowManager {
     await _channel.invokeMethod('setTitleBarStyle', arguments);
   }
 
+  /// Uses a native header bar for the title and caption buttons instead of
+  /// drawing them in Flutter, e.g. with `WindowCaption`.
+  ///
+  /// Hover, press and drag are handled natively. Caption buttons are
+  /// reported through the regular [WindowListener] events. `height` sets the
+  /// header bar height and `decorationLayout` overrides the system button
+  /// layout, e.g. `':minimize,maximize,close'`.
+  ///
+  /// @platforms linux
+  Future<void> setNativeTitleBar(
+    bool enabled, {
+    double? height,
+    String? decorationLayout,
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'enabled': enabled,
+      'height': height,
+      'decorationLayout': decorationLayout,
+    }..removeWhere((key, value) => value == null);
+    await _channel.invokeMethod('setNativeTitleBar', arguments);
+  }
+
   /// Returns `int` - The title bar height of the native window.
   Future<int> getTitleBarHeight() async {
     return await _channel.invokeMethod('getTitleBarHeight');
@@ -709,6 +955,42 @@ class WindowManager {
     await _channel.invokeMethod('setIgnoreMouseEvents', arguments);
   }
 
+  /// Lets clicks pass through the pixels of the window whose alpha in `mask`
+  /// is below `threshold`. `mask` holds one byte per logical pixel, row by
+  /// row, for a `width` x `height` area at the top left of the window.
+  ///
+  /// Pixels outside that area are click-through as well. Clicks on
+  /// click-through pixels go to the windows underneath. A mask set before
+  /// the window is shown applies once it is.
+  ///
+  /// Returns how long the mask took to convert into an input region. Masks
+  /// which differ from the previous one in a few rows convert faster.
+  ///
+  /// @platforms linux
+  Future<Duration> setInputMask(
+    Uint8List mask, {
+    required int width,
+    required int height,
+    int threshold = 128,
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'mask': mask,
+      'width': width,
+      'height': height,
+      'threshold': threshold,
+    };
+    final int conversionTime =
+        await _channel.invokeMethod('setInputMask', arguments);
+    return Duration(microseconds: conversionTime);
+  }
+
+  /// Makes the whole window receive clicks again after [setInputMask].
+  ///
+  /// @platforms linux
+  Future<void> clearInputMask() async {
+    await _channel.invokeMethod('setInputMask', <String, dynamic>{});
+  }
+
   Future<void> popUpWindowMenu() async {
     final Map<String, dynamic> arguments = {};
     await _channel.invokeMethod('popUpWindowMenu', arguments);
@@ -721,6 +1003,39 @@ class WindowManager {
     await _channel.invokeMethod('startDragging');
   }
 
+  /// Sets whether [startDragging] snaps the window to the monitor workarea
+  /// edges and to the sibling rectangles in `targets` when they are closer
+  /// than `distance`.
+  ///
+  /// While snapping is enabled, the drag is run by the plugin instead of the
+  /// window manager. [WindowListener.onWindowMove] is not called during the
+  /// drag. The final position is reported once when the drag ends, through
+  /// [WindowListener.onWindowMove] and [WindowListener.onWindowMoved]. The
+  /// edges snapped are those of the bounds, frame included.
+  ///
+  /// @platforms linux
+  Future<void> setDragSnapping(
+    bool enabled, {
+    double? distance,
+    List<Rect>? targets,
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'enabled': enabled,
+      'distance': distance,
+      'targets': targets == null
+          ? null
+          : Float64List.fromList([
+              for (final Rect rect in targets) ...[
+                rect.left,
+                rect.top,
+                rect.width,
+                rect.height,
+              ],
+            ]),
+    }..removeWhere((key, value) => value == null);
+    await _channel.invokeMethod('setDragSnapping', arguments);
+  }
+
   /// Starts a window resize based on the specified mouse-down & mouse-move event.
   /// On Windows, this is disabled during full screen mode.
   ///
@@ -749,8 +1064,17 @@ class WindowManager {
 
   /// Grabs the keyboard.
   /// @platforms linux
-  Future<bool> grabKeyboard() async {
-    return await _channel.invokeMethod('grabKeyboard');
+  ///
+  /// While the keyboard is grabbed, `accelerators` are matched natively
+  /// before key events reach Flutter, so they keep working when the UI
+  /// isolate is busy. Matched keys are not passed on to Flutter.
+  Future<bool> grabKeyboard({
+    List<WindowAccelerator> accelerators = const [],
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'accelerators': accelerators.map((e) => e.toJson()).toList(),
+    };
+    return await _channel.invokeMethod('grabKeyboard', arguments);
   }
 
   /// Ungrabs the keyboard.
@@ -758,6 +1082,94 @@ class WindowManager {
   Future<bool> ungrabKeyboard() async {
     return await _channel.invokeMethod('ungrabKeyboard');
   }
+
+  /// Grabs the pointer, keeps it inside the window and hides the cursor.
+  ///
+  /// While locked, relative pointer motion is accumulated natively and
+  /// delivered once per frame through [WindowListener.onWindowPointerMotion].
+  ///
+  /// Only supported on X11. On Wayland, it throws a [PlatformException] with
+  /// the code `unsupported`.
+  /// @platforms linux
+  Future<bool> lockPointer() async {
+    return await _channel.invokeMethod('lockPointer');
+  }
+
+  /// Releases the pointer grabbed by [lockPointer].
+  /// @platforms linux
+  Future<bool> unlockPointer() async {
+    return await _channel.invokeMethod('unlockPointer');
+  }
+
+  /// Sets how long a native method or window signal handler may take before
+  /// it is logged as slow and flagged in the flight recorder. Defaults to
+  /// 4 milliseconds. Slow handlers are logged at the debug level, which
+  /// `G_MESSAGES_DEBUG=all` shows.
+  ///
+  /// Throws a [PlatformException] if `budget` is not positive.
+  /// @platforms linux
+  Future<void> setSlowHandlerBudget(Duration budget) async {
+    final Map<String, dynamic> arguments = {
+      'budget': budget.inMicroseconds,
+    };
+    await _channel.invokeMethod('setSlowHandlerBudget', arguments);
+  }
+
+  /// Returns the path of the file the flight recorder maps. The file holds
+  /// the latest method calls, events and window state changes. It is kept
+  /// if the app does not exit cleanly, or null if it could not be created.
+  /// @platforms linux
+  Future<String?> getFlightRecorderPath() async {
+    return await _channel.invokeMethod('getFlightRecorderPath');
+  }
+
+  /// Starts or stops measuring how late a low priority heartbeat, run every
+  /// `interval`, is dispatched by the main loop the plugin shares with GTK
+  /// and the platform channels.
+  ///
+  /// Beats later than `stallThreshold` count as stalls. With `emitStalls`,
+  /// each stall is also reported to
+  /// [WindowListener.onWindowMainLoopStall].
+  /// @platforms linux
+  Future<void> setMainLoopMonitor(
+    bool enabled, {
+    Duration interval = const Duration(milliseconds: 100),
+    Duration stallThreshold = const Duration(milliseconds: 50),
+    bool emitStalls = false,
+  }) async {
+    final Map<String, dynamic> arguments = {
+      'enabled': enabled,
+      'interval': interval.inMilliseconds,
+      'stallThreshold': stallThreshold.inMicroseconds,
+      'emitStalls': emitStalls,
+    };
+    await _channel.invokeMethod('setMainLoopMonitor', arguments);
+  }
+
+  /// Returns the statistics of the main loop monitor: `heartbeats`,
+  /// `stalls`, `maxLag` in microseconds and `lagHistogram`, whose entry `i`
+  /// counts the lags between 2^i and 2^(i+1) microseconds.
+  /// @platforms linux
+  Future<Map<String, dynamic>> getMainLoopStats() async {
+    final Map<dynamic, dynamic> stats =
+        await _channel.invokeMethod('getMainLoopStats');
+    return Map<String, dynamic>.from(stats);
+  }
+
+  /// Returns the number of calls and the total and maximum latency in
+  /// microseconds of each method handled natively, keyed by method name.
+  ///
+  /// Calls made through the automation socket are included. The socket is
+  /// opened at the path given by the `WINDOW_MANAGER_AUTOMATION_SOCKET`
+  /// environment variable.
+  /// @platforms linux
+  Future<Map<String, Map<String, int>>> getMethodStats() async {
+    final Map<dynamic, dynamic> stats =
+        await _channel.invokeMethod('getMethodStats');
+    return stats.map(
+      (key, value) => MapEntry(key as String, Map<String, int>.from(value)),
+    );
+  }
 }
 
 final windowManager = WindowManager.instance;
@@ -0,0 +1,62 @@
+import 'dart:ui';
+
+enum WindowPlacementState {
+  normal,
+  maximized,
+  minimized,
+  fullScreen,
+}
+
+/// Where and how the window is placed, as tracked by the platform.
+///
+/// Use [WindowManager.getPlacement] to save the layout of the window and
+/// [WindowManager.setPlacement] to restore it.
+class WindowPlacement {
+  const WindowPlacement({
+    required this.normalBounds,
+    this.state = WindowPlacementState.normal,
+    this.monitor,
+    this.workspace,
+  });
+
+  factory WindowPlacement.fromJson(Map<dynamic, dynamic> json) {
+    return WindowPlacement(
+      normalBounds: Rect.fromLTWH(
+        json['x'],
+        json['y'],
+        json['width'],
+        json['height'],
+      ),
+      state: WindowPlacementState.values.byName(json['state']),
+      monitor: json['monitor'] == -1 ? null : json['monitor'],
+      workspace: json['workspace'],
+    );
+  }
+
+  /// The bounds of the window when it is neither maximized, minimized nor
+  /// full screen, including while it is.
+  final Rect normalBounds;
+  final WindowPlacementState state;
+
+  /// The index of the monitor which contains [normalBounds]. When that
+  /// monitor is gone, [WindowManager.setPlacement] moves the window onto
+  /// this monitor, or onto the primary one.
+  final int? monitor;
+
+  /// The index of the workspace (virtual desktop) of the window.
+  ///
+  /// @platforms linux
+  final int? workspace;
+
+  Map<String, dynamic> toJson() {
+    return {
+      'x': normalBounds.left,
+      'y': normalBounds.top,
+      'width': normalBounds.width,
+      'height': normalBounds.height,
+      'state': state.name,
+      'monitor': monitor,
+      'workspace': workspace,
+    }..removeWhere((key, value) => value == null);
+  }
+}
@@ -0,0 +1,26 @@
+enum WindowTransitionEasing {
+  linear,
+  easeIn,
+  easeOut,
+  easeInOut,
+}
+
+/// A transition run natively when the window is shown or hidden.
+class WindowTransition {
+  /// Fades the window in or out over `duration`.
+  const WindowTransition.fade({
+    this.duration = const Duration(milliseconds: 150),
+    this.easing = WindowTransitionEasing.easeOut,
+  });
+
+  final Duration duration;
+  final WindowTransitionEasing easing;
+
+  Map<String, dynamic> toJson() {
+    return {
+      'type': 'fade',
+      'duration': duration.inMicroseconds,
+      'easing': easing.name,
+    };
+  }
+}
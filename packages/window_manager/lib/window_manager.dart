@@ -6,6 +6,10 @@ export 'src/widgets/drag_to_resize_area.dart';
 export 'src/widgets/virtual_window_frame.dart';
 export 'src/widgets/window_caption.dart';
 export 'src/widgets/window_caption_button.dart';
+export 'src/window_accelerator.dart';
+export 'src/window_event_port.dart';
 export 'src/window_listener.dart';
 export 'src/window_manager.dart';
 export 'src/window_options.dart';
+export 'src/window_placement.dart';
+export 'src/window_transition.dart';
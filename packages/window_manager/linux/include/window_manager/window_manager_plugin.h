@@ -21,6 +21,18 @@ FLUTTER_PLUGIN_EXPORT GType window_manager_plugin_get_type();
 FLUTTER_PLUGIN_EXPORT void window_manager_plugin_register_with_registrar(
     FlPluginRegistrar* registrar);
 
+// Called through dart:ffi with NativeApi.postCObject, so that window events
+// can be posted to native ports of any isolate.
+FLUTTER_PLUGIN_EXPORT void window_manager_plugin_set_post_cobject(void* func);
+
+// Posts the events whose id bits are set in event_mask to the native port.
+FLUTTER_PLUGIN_EXPORT void window_manager_plugin_subscribe_port(
+    gint64 port,
+    guint32 event_mask);
+
+FLUTTER_PLUGIN_EXPORT void window_manager_plugin_unsubscribe_port(
+    gint64 port);
+
 G_END_DECLS
 
 #endif  // FLUTTER_PLUGIN_WINDOW_MANAGER_PLUGIN_H_
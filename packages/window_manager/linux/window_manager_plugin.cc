@@ -1,7 +1,26 @@
 #include "include/window_manager/window_manager_plugin.h"
 
 #include <flutter_linux/flutter_linux.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
+#include <sys/mman.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#ifdef GDK_WINDOWING_X11
+#include <gdk/gdkx.h>
+#ifdef WINDOW_MANAGER_HAS_XI2
+#include <X11/extensions/XInput2.h>
+#endif
+#endif
 
 #define WINDOW_MANAGER_PLUGIN(obj)                                     \
   (G_TYPE_CHECK_INSTANCE_CAST((obj), window_manager_plugin_get_type(), \
@@ -11,6 +30,8 @@ struct _WindowManagerPlugin {
   GObject parent_instance;
   FlPluginRegistrar* registrar;
   FlMethodChannel* channel;
+  GtkWindow* window;
+  gulong button_press_hook_id;
   GdkGeometry window_geometry;
   GdkWindowHints window_hints;
   GtkWidget* _event_box;
@@ -23,22 +44,491 @@ struct _WindowManagerPlugin {
   gchar* title_bar_style_;
   GdkEventButton _event_button;
   GdkDevice* grab_pointer;
+  GHashTable* accelerators;
+  gulong accelerator_handler_id;
   GtkCssProvider* css_provider;
+  bool _is_pointer_locked;
+  bool _is_raw_motion;
+  int xi_opcode;
+  gulong pointer_motion_handler_id;
+  guint pointer_motion_tick_id;
+  gdouble pointer_last_x;
+  gdouble pointer_last_y;
+  gdouble pointer_delta_x;
+  gdouble pointer_delta_y;
+  gint pointer_motion_count;
+  gint64 full_screen_request_time;
+  bool _is_bypass_compositor;
+  guint inhibit_cookie;
+  GDBusConnection* session_bus;
+  GCancellable* session_bus_cancellable;
+  guint color_scheme_subscription_id;
+  gint portal_color_scheme;
+  gulong theme_name_handler_id;
+  guint brightness_changed_source_id;
+  bool _is_setting_brightness;
+  bool _is_dark;
+  bool _is_snapping;
+  bool _is_snap_dragging;
+  gint snap_distance;
+  GArray* snap_targets;
+  gint drag_offset_x;
+  gint drag_offset_y;
+  gulong snap_motion_handler_id;
+  gulong snap_release_handler_id;
+  GHashTable* method_stats;
+  FlBasicMessageChannel* lifecycle_channel;
+  gulong lifecycle_visible_handler_id;
+  gulong lifecycle_active_handler_id;
+  gulong lifecycle_state_handler_id;
+  GdkWindow* lifecycle_root_window;
+  guint main_loop_monitor_source_id;
+  gint64 main_loop_interval;
+  gint64 main_loop_stall_threshold;
+  gint64 main_loop_last_tick;
+  bool _is_emitting_main_loop_stalls;
+  gint64 main_loop_lag_histogram[20];
+  gint64 main_loop_ticks;
+  gint64 main_loop_stalls;
+  gint64 main_loop_max_lag;
+  GBytes* input_mask;
+  gint input_mask_width;
+  guint8 input_mask_threshold;
+  GArray* input_mask_runs;
+  GArray* input_mask_row_starts;
+  cairo_region_t* input_mask_region;
+  GtkWidget* header_bar;
+  bool _is_header_bar_searched;
+  gint title_bar_height;
+  GtkBorder frame_extents;
+  GdkRectangle normal_bounds;
+  GdkRectangle previous_normal_bounds;
+  bool _has_normal_bounds;
+  GtkBorder shadow_extents;
+  guint frame_metrics_changed_source_id;
+  guint transition_tick_id;
+  gint64 transition_start_time;
+  gint64 transition_duration;
+  gchar* transition_easing;
+  gdouble transition_from_opacity;
+  gdouble transition_to_opacity;
+  gdouble transition_opacity;
+  bool _is_transition_hiding;
+  GSocketService* automation_service;
+  GCancellable* automation_cancellable;
+  gchar* automation_socket_path;
 };
 
 G_DEFINE_TYPE(WindowManagerPlugin, window_manager_plugin, g_object_get_type())
 
-// Gets the window being controlled.
+// Gets the window being controlled, the toplevel of the view when the
+// plugin was registered. It is tracked rather than looked up from the view,
+// which is usually gone by the time the plugin is disposed.
 GtkWindow* get_window(WindowManagerPlugin* self) {
-  FlView* view = fl_plugin_registrar_get_view(self->registrar);
-  if (view == nullptr)
+  return self->window;
+}
+
+GdkWindow* get_gdk_window(WindowManagerPlugin* self) {
+  GtkWindow* window = get_window(self);
+  if (window == nullptr)
     return nullptr;
 
-  return GTK_WINDOW(gtk_widget_get_toplevel(GTK_WIDGET(view)));
+  return gtk_widget_get_window(GTK_WIDGET(window));
+}
+
+// The flight recorder keeps the last kFlightRecordCount method calls, signal
+// callbacks, events and window state changes in a file mapped with
+// MAP_SHARED, so that they can be read while the app hangs or after it
+// crashed. The file is window_manager-<pid>.flight in the user runtime
+// directory and holds a FlightRecorderHeader followed by a ring of
+// FlightRecords. It is only written from the platform thread.
+//
+// A handler's record is written when it starts and completed when it
+// returns, so that the handler a hung app is stuck in can be found.
+typedef enum {
+  kFlightRecordMethodCall = 1,
+  kFlightRecordSignal = 2,
+  kFlightRecordEvent = 3,
+  kFlightRecordWindowState = 4,
+} FlightRecordKind;
+
+// Set on records which took longer than slow_handler_budget.
+#define FLIGHT_RECORD_SLOW (1 << 0)
+// Set on records of handlers which have not returned yet.
+#define FLIGHT_RECORD_IN_PROGRESS (1 << 1)
+// Set on records of method calls which returned an error.
+#define FLIGHT_RECORD_FAILED (1 << 2)
+
+typedef struct {
+  // Monotonic time at which the record started, in microseconds.
+  gint64 time;
+  // In microseconds, or 0 while the record is in progress.
+  gint32 duration;
+  guint16 kind;
+  guint16 flags;
+  // The GdkWindowState when the record started, then when it ended.
+  guint32 window_state;
+  guint32 reserved;
+  gchar name[40];
+} FlightRecord;
+G_STATIC_ASSERT(sizeof(FlightRecord) == 64);
+
+typedef struct {
+  gchar magic[4];
+  guint32 version;
+  guint32 record_size;
+  guint32 record_count;
+  // The number of records written so far. The next one goes to
+  // next_record % record_count.
+  guint64 next_record;
+  guint64 reserved;
+} FlightRecorderHeader;
+
+static const guint32 kFlightRecordCount = 1024;
+
+static FlightRecorderHeader* flight_recorder = nullptr;
+static gchar* flight_recorder_path = nullptr;
+static guint flight_recorder_users = 0;
+static gint64 slow_handler_budget = 4000;
+
+// The longest handler since the main loop monitor last ran, so that stalls
+// can be attributed to it.
+static gchar longest_handler_name[40];
+static gint64 longest_handler_duration = 0;
+
+static gsize flight_recorder_size() {
+  return sizeof(FlightRecorderHeader) +
+         kFlightRecordCount * sizeof(FlightRecord);
+}
+
+static void open_flight_recorder() {
+  if (flight_recorder_users++ > 0)
+    return;
+
+  g_autofree gchar* name =
+      g_strdup_printf("window_manager-%d.flight", getpid());
+  g_autofree gchar* path =
+      g_build_filename(g_get_user_runtime_dir(), name, nullptr);
+  int fd = g_open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    g_warning("Failed to create flight recorder %s: %s", path,
+              g_strerror(errno));
+    return;
+  }
+  void* data = MAP_FAILED;
+  if (ftruncate(fd, flight_recorder_size()) == 0) {
+    data = mmap(nullptr, flight_recorder_size(), PROT_READ | PROT_WRITE,
+                MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) {
+    g_warning("Failed to map flight recorder %s: %s", path, g_strerror(errno));
+    g_unlink(path);
+    return;
+  }
+
+  flight_recorder = static_cast<FlightRecorderHeader*>(data);
+  memcpy(flight_recorder->magic, "WMFR", sizeof(flight_recorder->magic));
+  flight_recorder->version = 2;
+  flight_recorder->record_size = sizeof(FlightRecord);
+  flight_recorder->record_count = kFlightRecordCount;
+  flight_recorder_path = g_steal_pointer(&path);
+}
+
+// Unmaps and removes the flight recorder once the last window is gone, as
+// it is only needed when the app does not exit cleanly.
+static void close_flight_recorder() {
+  if (flight_recorder_users == 0 || --flight_recorder_users > 0)
+    return;
+
+  if (flight_recorder != nullptr) {
+    munmap(flight_recorder, flight_recorder_size());
+    flight_recorder = nullptr;
+    g_unlink(flight_recorder_path);
+    g_clear_pointer(&flight_recorder_path, g_free);
+  }
 }
 
-GdkWindow* get_gdk_window(WindowManagerPlugin* self) {
-  return gtk_widget_get_window(GTK_WIDGET(get_window(self)));
+static FlightRecord* get_flight_record(guint64 index) {
+  FlightRecord* records = reinterpret_cast<FlightRecord*>(flight_recorder + 1);
+  return &records[index % kFlightRecordCount];
+}
+
+// Writes a record and returns its index, which stays valid for
+// complete_flight_record() until the ring wraps around.
+static guint64 write_flight_record(FlightRecordKind kind,
+                                   const gchar* name,
+                                   gint64 time,
+                                   gint64 duration,
+                                   guint32 window_state,
+                                   guint16 flags) {
+  if (flight_recorder == nullptr)
+    return 0;
+
+  guint64 index = flight_recorder->next_record;
+  FlightRecord* record = get_flight_record(index);
+  record->time = time;
+  record->duration = static_cast<gint32>(MIN(duration, G_MAXINT32));
+  record->kind = kind;
+  record->flags = flags;
+  record->window_state = window_state;
+  g_strlcpy(record->name, name, sizeof(record->name));
+  flight_recorder->next_record++;
+  return index;
+}
+
+// Completes the in-progress record at index, or writes a new one if it has
+// been overwritten by the records of nested handlers.
+static void complete_flight_record(guint64 index,
+                                   FlightRecordKind kind,
+                                   const gchar* name,
+                                   gint64 time,
+                                   gint64 duration,
+                                   guint32 window_state,
+                                   guint16 flags) {
+  if (flight_recorder == nullptr)
+    return;
+
+  if (flight_recorder->next_record - index > kFlightRecordCount) {
+    write_flight_record(kind, name, time, duration, window_state, flags);
+    return;
+  }
+
+  FlightRecord* record = get_flight_record(index);
+  record->duration = static_cast<gint32>(MIN(duration, G_MAXINT32));
+  record->window_state = window_state;
+  record->flags = flags;
+}
+
+// Records the time spent until the end of the scope, warning about and
+// flagging handlers which take longer than slow_handler_budget.
+class FlightRecorderScope {
+ public:
+  FlightRecorderScope(WindowManagerPlugin* self,
+                      FlightRecordKind kind,
+                      const gchar* name)
+      : self_(self),
+        kind_(kind),
+        name_(name),
+        start_time_(g_get_monotonic_time()),
+        flags_(0) {
+    index_ = write_flight_record(kind_, name_, start_time_, 0,
+                                 get_window_state(), FLIGHT_RECORD_IN_PROGRESS);
+  }
+
+  ~FlightRecorderScope() {
+    gint64 duration = g_get_monotonic_time() - start_time_;
+    guint32 window_state = get_window_state();
+    guint16 flags = flags_;
+    if (duration > slow_handler_budget) {
+      flags |= FLIGHT_RECORD_SLOW;
+      // Not a warning, since a tight loop of slow calls would flood the
+      // journal, and fatal-warnings would turn a slow handler into a crash.
+      g_debug("%s took %" G_GINT64_FORMAT " us, over the budget of %"
+              G_GINT64_FORMAT " us",
+              name_, duration, slow_handler_budget);
+    }
+    complete_flight_record(index_, kind_, name_, start_time_, duration,
+                           window_state, flags);
+    if (duration > longest_handler_duration) {
+      g_strlcpy(longest_handler_name, name_, sizeof(longest_handler_name));
+      longest_handler_duration = duration;
+    }
+  }
+
+  void set_failed() { flags_ |= FLIGHT_RECORD_FAILED; }
+
+ private:
+  guint32 get_window_state() {
+    GdkWindow* window = get_gdk_window(self_);
+    return window != nullptr ? gdk_window_get_state(window) : 0;
+  }
+
+  WindowManagerPlugin* self_;
+  FlightRecordKind kind_;
+  const gchar* name_;
+  gint64 start_time_;
+  guint16 flags_;
+  guint64 index_;
+};
+
+// The subset of Dart_CObject from the Dart SDK's dart_native_api.h which is
+// needed to post an array of integers to a native port.
+typedef int64_t Dart_Port;
+typedef enum {
+  Dart_CObject_kNull = 0,
+  Dart_CObject_kBool,
+  Dart_CObject_kInt32,
+  Dart_CObject_kInt64,
+  Dart_CObject_kDouble,
+  Dart_CObject_kString,
+  Dart_CObject_kArray,
+} Dart_CObject_Type;
+typedef struct _Dart_CObject {
+  Dart_CObject_Type type;
+  union {
+    int64_t as_int64;
+    struct {
+      intptr_t length;
+      struct _Dart_CObject** values;
+    } as_array;
+    // Keeps the union as large as the SDK's, which has wider members.
+    struct {
+      int64_t padding[5];
+    } reserved;
+  } value;
+} Dart_CObject;
+typedef int8_t (*Dart_PostCObjectFunc)(Dart_Port port_id,
+                                       Dart_CObject* message);
+
+// Window events in the order of the ids in the records posted to native
+// ports. Must match kWindowEvents in lib/src/window_event_port.dart.
+static const gchar* kWindowEvents[] = {
+    "close",
+    "focus",
+    "blur",
+    "maximize",
+    "unmaximize",
+    "minimize",
+    "restore",
+    "resize",
+    "resized",
+    "move",
+    "moved",
+    "enter-full-screen",
+    "leave-full-screen",
+    "docked",
+    "undocked",
+    "show",
+    "hide",
+    "pointer-motion",
+    "brightness-changed",
+    "transition-end",
+    "frame-metrics-changed",
+    "accelerator",
+    "main-loop-stall",
+};
+
+// Subscriptions hold one bit per event in a guint32.
+static_assert(G_N_ELEMENTS(kWindowEvents) <= 32,
+              "kWindowEvents does not fit in PortSubscription::event_mask");
+
+typedef struct {
+  Dart_Port port;
+  guint32 event_mask;
+} PortSubscription;
+
+// Ports are registered through FFI from any isolate thread, while events are
+// posted from the platform thread.
+static GMutex port_subscriptions_mutex;
+static GArray* port_subscriptions = nullptr;
+static Dart_PostCObjectFunc post_cobject = nullptr;
+
+void window_manager_plugin_set_post_cobject(void* func) {
+  g_mutex_lock(&port_subscriptions_mutex);
+  post_cobject = reinterpret_cast<Dart_PostCObjectFunc>(func);
+  g_mutex_unlock(&port_subscriptions_mutex);
+}
+
+void window_manager_plugin_subscribe_port(gint64 port, guint32 event_mask) {
+  g_mutex_lock(&port_subscriptions_mutex);
+  if (port_subscriptions == nullptr) {
+    port_subscriptions = g_array_new(false, false, sizeof(PortSubscription));
+  }
+  // Subscribing a port again replaces its events, so that a single
+  // unsubscribe always stops them.
+  for (guint i = 0; i < port_subscriptions->len; i++) {
+    PortSubscription* subscription =
+        &g_array_index(port_subscriptions, PortSubscription, i);
+    if (subscription->port == port) {
+      subscription->event_mask = event_mask;
+      g_mutex_unlock(&port_subscriptions_mutex);
+      return;
+    }
+  }
+  PortSubscription subscription = {port, event_mask};
+  g_array_append_val(port_subscriptions, subscription);
+  g_mutex_unlock(&port_subscriptions_mutex);
+}
+
+void window_manager_plugin_unsubscribe_port(gint64 port) {
+  g_mutex_lock(&port_subscriptions_mutex);
+  guint length = port_subscriptions != nullptr ? port_subscriptions->len : 0;
+  for (guint i = 0; i < length; i++) {
+    if (g_array_index(port_subscriptions, PortSubscription, i).port == port) {
+      g_array_remove_index_fast(port_subscriptions, i);
+      break;
+    }
+  }
+  g_mutex_unlock(&port_subscriptions_mutex);
+}
+
+// Returns the index of the event in kWindowEvents, or -1.
+static gint get_window_event_id(const char* event_name) {
+  for (guint id = 0; id < G_N_ELEMENTS(kWindowEvents); id++) {
+    if (g_strcmp0(kWindowEvents[id], event_name) == 0)
+      return id;
+  }
+  return -1;
+}
+
+// Posts [event id, monotonic time in microseconds] to every port subscribed
+// to the event, bypassing the method channel.
+static void post_event_to_ports(gint id) {
+  g_mutex_lock(&port_subscriptions_mutex);
+  if (post_cobject != nullptr && port_subscriptions != nullptr &&
+      port_subscriptions->len > 0) {
+    Dart_CObject event_id = {Dart_CObject_kInt64, {}};
+    event_id.value.as_int64 = id;
+    Dart_CObject timestamp = {Dart_CObject_kInt64, {}};
+    timestamp.value.as_int64 = g_get_monotonic_time();
+    Dart_CObject* values[] = {&event_id, &timestamp};
+    Dart_CObject record = {Dart_CObject_kArray, {}};
+    record.value.as_array.length = G_N_ELEMENTS(values);
+    record.value.as_array.values = values;
+
+    for (guint i = 0; i < port_subscriptions->len; i++) {
+      PortSubscription* subscription =
+          &g_array_index(port_subscriptions, PortSubscription, i);
+      if (subscription->event_mask & (1u << id)) {
+        post_cobject(subscription->port, &record);
+      }
+    }
+  }
+  g_mutex_unlock(&port_subscriptions_mutex);
+}
+
+// Sends an event to Dart, taking ownership of the optional event_data.
+void _emit_event_data(WindowManagerPlugin* plugin,
+                      const char* event_name,
+                      FlValue* event_data) {
+  write_flight_record(kFlightRecordEvent, event_name, g_get_monotonic_time(),
+                      0, 0, 0);
+  gint event_id = get_window_event_id(event_name);
+  if (event_id >= 0)
+    post_event_to_ports(event_id);
+  g_autoptr(FlValue) result_data = fl_value_new_map();
+  fl_value_set_string_take(result_data, "eventName",
+                           fl_value_new_string(event_name));
+  // Lets Dart index its handlers instead of looking the name up.
+  if (event_id >= 0) {
+    fl_value_set_string_take(result_data, "eventId",
+                             fl_value_new_int(event_id));
+  }
+  if (event_data != nullptr) {
+    fl_value_set_string_take(result_data, "eventData", event_data);
+  }
+  fl_method_channel_invoke_method(plugin->channel, "onEvent", result_data,
+                                  nullptr, nullptr, nullptr);
+}
+
+void _emit_event(WindowManagerPlugin* plugin, const char* event_name) {
+  _emit_event_data(plugin, event_name, nullptr);
+}
+
+static FlMethodResponse* ensure_initialized(WindowManagerPlugin* self) {
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
 static FlMethodResponse* set_as_frameless(WindowManagerPlugin* self,
@@ -92,13 +582,7 @@ static FlMethodResponse* is_focused(WindowManagerPlugin* self) {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
-static FlMethodResponse* show(WindowManagerPlugin* self) {
-  gtk_widget_show(GTK_WIDGET(get_window(self)));
-  g_autoptr(FlValue) result = fl_value_new_bool(true);
-  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
-}
-
-static FlMethodResponse* hide(WindowManagerPlugin* self) {
+static void hide_window(WindowManagerPlugin* self) {
   gint x, y, width, height;
   // store the bound of window before hide
   gtk_window_get_position(get_window(self), &x, &y);
@@ -107,6 +591,189 @@ static FlMethodResponse* hide(WindowManagerPlugin* self) {
   // restore the bound of window after hide
   gtk_window_move(get_window(self), x, y);
   gtk_window_resize(get_window(self), width, height);
+}
+
+static gdouble ease(const gchar* easing, gdouble t) {
+  if (g_strcmp0(easing, "easeIn") == 0)
+    return t * t * t;
+  if (g_strcmp0(easing, "easeOut") == 0)
+    return 1 - (1 - t) * (1 - t) * (1 - t);
+  if (g_strcmp0(easing, "easeInOut") == 0)
+    return t < 0.5 ? 4 * t * t * t : 1 - 4 * (1 - t) * (1 - t) * (1 - t);
+  return t;
+}
+
+static void remove_transition_tick(WindowManagerPlugin* self) {
+  GtkWindow* window = get_window(self);
+  if (self->transition_tick_id != 0 && window != nullptr) {
+    gtk_widget_remove_tick_callback(GTK_WIDGET(window),
+                                    self->transition_tick_id);
+  }
+  self->transition_tick_id = 0;
+}
+
+// Stops the running transition and puts back the opacity the window had
+// before it.
+static void cancel_transition(WindowManagerPlugin* self) {
+  if (self->transition_tick_id == 0)
+    return;
+
+  remove_transition_tick(self);
+  gtk_widget_set_opacity(GTK_WIDGET(get_window(self)),
+                         self->transition_opacity);
+}
+
+static gboolean on_transition_tick(GtkWidget* widget,
+                                   GdkFrameClock* frame_clock,
+                                   gpointer user_data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(user_data);
+
+  // The transition starts with the first frame drawn after it was requested,
+  // so that a window being shown is not faded in before it has content.
+  gint64 frame_time = gdk_frame_clock_get_frame_time(frame_clock);
+  if (self->transition_start_time == 0)
+    self->transition_start_time = frame_time;
+
+  gdouble t = self->transition_duration > 0
+                  ? static_cast<gdouble>(frame_time -
+                                         self->transition_start_time) /
+                        self->transition_duration
+                  : 1;
+  t = CLAMP(t, 0, 1);
+  gdouble progress = ease(self->transition_easing, t);
+  gtk_widget_set_opacity(
+      widget, self->transition_from_opacity +
+                  (self->transition_to_opacity -
+                   self->transition_from_opacity) *
+                      progress);
+  if (t < 1)
+    return G_SOURCE_CONTINUE;
+
+  self->transition_tick_id = 0;
+  bool is_visible = !self->_is_transition_hiding;
+  if (self->_is_transition_hiding) {
+    hide_window(self);
+    gtk_widget_set_opacity(widget, self->transition_opacity);
+  }
+
+  FlValue* event_data = fl_value_new_map();
+  fl_value_set_string_take(event_data, "visible",
+                           fl_value_new_bool(is_visible));
+  _emit_event_data(self, "transition-end", event_data);
+  return G_SOURCE_REMOVE;
+}
+
+typedef struct {
+  gchar code;
+  FlValueType type;
+  const gchar* name;
+} ArgType;
+
+static const ArgType kArgTypes[] = {
+    {'b', FL_VALUE_TYPE_BOOL, "bool"},
+    {'i', FL_VALUE_TYPE_INT, "int"},
+    {'d', FL_VALUE_TYPE_FLOAT, "double"},
+    {'s', FL_VALUE_TYPE_STRING, "string"},
+    {'l', FL_VALUE_TYPE_LIST, "list"},
+    {'m', FL_VALUE_TYPE_MAP, "map"},
+    {'B', FL_VALUE_TYPE_UINT8_LIST, "uint8 list"},
+    {'D', FL_VALUE_TYPE_FLOAT_LIST, "float list"},
+};
+
+// Returns whether `args` is a map holding the arguments described by
+// `signature`, in the format of MethodEntry::args, so that the
+// fl_value_get_* calls of a handler cannot see a value of the wrong type.
+// Otherwise sets `message`, if it is not null, to what is wrong.
+static bool has_args(const gchar* signature, FlValue* args, gchar** message) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    if (message != nullptr)
+      *message = g_strdup("Arguments must be a map");
+    return false;
+  }
+
+  g_auto(GStrv) specs = g_strsplit(signature, " ", -1);
+  for (gchar** spec = specs; *spec != nullptr; spec++) {
+    gchar* code = strchr(*spec, ':');
+    g_return_val_if_fail(code != nullptr, false);
+    *code++ = '\0';
+    gsize key_length = strlen(*spec);
+    bool is_optional = key_length > 0 && (*spec)[key_length - 1] == '?';
+    if (is_optional)
+      (*spec)[key_length - 1] = '\0';
+
+    const ArgType* type = nullptr;
+    for (const ArgType& arg_type : kArgTypes) {
+      if (arg_type.code == *code)
+        type = &arg_type;
+    }
+    g_return_val_if_fail(type != nullptr, false);
+
+    // Handlers only check optional arguments for being absent, not null.
+    FlValue* value = fl_value_lookup_string(args, *spec);
+    if (value == nullptr && is_optional)
+      continue;
+    if (value == nullptr || fl_value_get_type(value) != type->type) {
+      if (message != nullptr)
+        *message = g_strdup_printf("%s must be a %s", *spec, type->name);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fades the window in or out from its current opacity, starting with the
+// next frame. Returns false if `args` has no fade transition.
+static bool start_transition(WindowManagerPlugin* self,
+                             FlValue* args,
+                             bool is_hiding) {
+  FlValue* transition = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                            ? fl_value_lookup_string(args, "transition")
+                            : nullptr;
+  if (transition == nullptr ||
+      !has_args("type:s easing:s duration:i", transition, nullptr) ||
+      g_strcmp0(fl_value_get_string(
+                    fl_value_lookup_string(transition, "type")),
+                "fade") != 0) {
+    return false;
+  }
+
+  GtkWidget* window = GTK_WIDGET(get_window(self));
+  // A transition interrupting another one continues from where it was, and
+  // keeps the opacity the window had before the first one.
+  if (self->transition_tick_id == 0)
+    self->transition_opacity = gtk_widget_get_opacity(window);
+  remove_transition_tick(self);
+
+  g_free(self->transition_easing);
+  self->transition_easing = g_strdup(
+      fl_value_get_string(fl_value_lookup_string(transition, "easing")));
+  self->transition_duration =
+      fl_value_get_int(fl_value_lookup_string(transition, "duration"));
+  self->transition_start_time = 0;
+  self->_is_transition_hiding = is_hiding;
+  if (!is_hiding && !gtk_widget_get_visible(window))
+    gtk_widget_set_opacity(window, 0);
+  self->transition_from_opacity = gtk_widget_get_opacity(window);
+  self->transition_to_opacity = is_hiding ? 0 : self->transition_opacity;
+  self->transition_tick_id = gtk_widget_add_tick_callback(
+      window, on_transition_tick, self, nullptr);
+  return true;
+}
+
+static FlMethodResponse* show(WindowManagerPlugin* self, FlValue* args) {
+  if (!start_transition(self, args, false))
+    cancel_transition(self);
+  gtk_widget_show(GTK_WIDGET(get_window(self)));
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* hide(WindowManagerPlugin* self, FlValue* args) {
+  bool is_visible = gtk_widget_get_visible(GTK_WIDGET(get_window(self)));
+  if (!is_visible || !start_transition(self, args, true)) {
+    cancel_transition(self);
+    hide_window(self);
+  }
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
@@ -148,6 +815,7 @@ static FlMethodResponse* minimize(WindowManagerPlugin* self) {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+#ifdef WINDOW_MANAGER_ENABLE_DOCKING
 static FlMethodResponse* is_dockable(WindowManagerPlugin* self) {
   bool is_docked = false;
   g_autoptr(FlValue) result = fl_value_new_bool(is_docked);
@@ -168,6 +836,7 @@ static FlMethodResponse* undock(WindowManagerPlugin* self) {
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
+#endif
 
 static FlMethodResponse* restore(WindowManagerPlugin* self) {
   gtk_window_deiconify(get_window(self));
@@ -183,20 +852,117 @@ static FlMethodResponse* is_full_screen(WindowManagerPlugin* self) {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+// Sets or clears the _NET_WM_BYPASS_COMPOSITOR hint, which asks X11
+// compositors to unredirect the window while it is fullscreen.
+static void set_bypass_compositor(WindowManagerPlugin* self,
+                                  bool bypass_compositor) {
+#ifdef GDK_WINDOWING_X11
+  GdkWindow* gdk_window = get_gdk_window(self);
+  if (!GDK_IS_X11_WINDOW(gdk_window))
+    return;
+
+  GdkAtom property = gdk_atom_intern_static_string("_NET_WM_BYPASS_COMPOSITOR");
+  if (bypass_compositor) {
+    gulong value = 1;
+    gdk_property_change(gdk_window, property,
+                        gdk_atom_intern_static_string("CARDINAL"), 32,
+                        GDK_PROP_MODE_REPLACE,
+                        reinterpret_cast<const guchar*>(&value), 1);
+  } else {
+    gdk_property_delete(gdk_window, property);
+  }
+  self->_is_bypass_compositor = bypass_compositor;
+#endif
+}
+
+static void set_inhibit_screensaver(WindowManagerPlugin* self,
+                                    bool inhibit_screensaver) {
+  GtkApplication* application = gtk_window_get_application(get_window(self));
+  if (application == nullptr)
+    return;
+
+  if (inhibit_screensaver && self->inhibit_cookie == 0) {
+    self->inhibit_cookie = gtk_application_inhibit(
+        application, get_window(self), GTK_APPLICATION_INHIBIT_IDLE,
+        "Fullscreen");
+  } else if (!inhibit_screensaver && self->inhibit_cookie != 0) {
+    gtk_application_uninhibit(application, self->inhibit_cookie);
+    self->inhibit_cookie = 0;
+  }
+}
+
+// Drops the hints requested together with full screen. Called whenever the
+// window leaves full screen, also by the window manager, so it does nothing
+// when they are not set.
+static void release_full_screen_hints(WindowManagerPlugin* self) {
+  if (self->_is_bypass_compositor)
+    set_bypass_compositor(self, false);
+  set_inhibit_screensaver(self, false);
+}
+
 static FlMethodResponse* set_full_screen(WindowManagerPlugin* self,
                                          FlValue* args) {
   bool is_full_screen =
       fl_value_get_bool(fl_value_lookup_string(args, "isFullScreen"));
-
-  if (is_full_screen)
-    gtk_window_fullscreen(get_window(self));
-  else
+  FlValue* monitor = fl_value_lookup_string(args, "monitor");
+  FlValue* bypass_compositor = fl_value_lookup_string(args, "bypassCompositor");
+  FlValue* inhibit_screensaver =
+      fl_value_lookup_string(args, "inhibitScreensaver");
+
+  // Only time actual transitions, since a call which leaves the state as it
+  // is causes no window-state-event to report the duration with.
+  GdkWindow* gdk_window = get_gdk_window(self);
+  bool was_full_screen = gdk_window != nullptr &&
+                         (gdk_window_get_state(gdk_window) &
+                          GDK_WINDOW_STATE_FULLSCREEN);
+  if (is_full_screen != was_full_screen)
+    self->full_screen_request_time = g_get_monotonic_time();
+
+  if (is_full_screen) {
+    if (bypass_compositor != nullptr && fl_value_get_bool(bypass_compositor))
+      set_bypass_compositor(self, true);
+    if (inhibit_screensaver != nullptr &&
+        fl_value_get_bool(inhibit_screensaver))
+      set_inhibit_screensaver(self, true);
+
+    if (monitor != nullptr && fl_value_get_type(monitor) == FL_VALUE_TYPE_INT) {
+      gtk_window_fullscreen_on_monitor(
+          get_window(self), gtk_window_get_screen(get_window(self)),
+          static_cast<gint>(fl_value_get_int(monitor)));
+    } else {
+      gtk_window_fullscreen(get_window(self));
+    }
+  } else {
     gtk_window_unfullscreen(get_window(self));
+    release_full_screen_hints(self);
+  }
 
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+// The minimum and maximum sizes are kept for the bounds, frame included,
+// like getBounds and setBounds. The hints apply to the client area, so the
+// frame is taken off, which is done again when the frame changes.
+static void apply_geometry_hints(WindowManagerPlugin* self) {
+  GdkWindow* gdk_window = get_gdk_window(self);
+  if (gdk_window == nullptr)
+    return;
+
+  GdkGeometry geometry = self->window_geometry;
+  gint frame_width = self->frame_extents.left + self->frame_extents.right;
+  gint frame_height = self->frame_extents.top + self->frame_extents.bottom;
+  if (geometry.min_width > 0)
+    geometry.min_width = MAX(geometry.min_width - frame_width, 0);
+  if (geometry.min_height > 0)
+    geometry.min_height = MAX(geometry.min_height - frame_height, 0);
+  if (geometry.max_width != G_MAXINT)
+    geometry.max_width = MAX(geometry.max_width - frame_width, 0);
+  if (geometry.max_height != G_MAXINT)
+    geometry.max_height = MAX(geometry.max_height - frame_height, 0);
+  gdk_window_set_geometry_hints(gdk_window, &geometry, self->window_hints);
+}
+
 static FlMethodResponse* set_aspect_ratio(WindowManagerPlugin* self,
                                           FlValue* args) {
   const float aspect_ratio =
@@ -213,12 +979,40 @@ static FlMethodResponse* set_aspect_ratio(WindowManagerPlugin* self,
         static_cast<GdkWindowHints>(self->window_hints & ~GDK_HINT_ASPECT);
   }
 
-  gdk_window_set_geometry_hints(get_gdk_window(self), &self->window_geometry,
-                                self->window_hints);
+  apply_geometry_hints(self);
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+static FlMethodResponse* set_resize_increments(WindowManagerPlugin* self,
+                                               FlValue* args) {
+  const float width = fl_value_get_float(fl_value_lookup_string(args, "width"));
+  const float height =
+      fl_value_get_float(fl_value_lookup_string(args, "height"));
+  const float base_width =
+      fl_value_get_float(fl_value_lookup_string(args, "baseWidth"));
+  const float base_height =
+      fl_value_get_float(fl_value_lookup_string(args, "baseHeight"));
+
+  if (width > 0 && height > 0) {
+    self->window_geometry.width_inc = static_cast<gint>(width);
+    self->window_geometry.height_inc = static_cast<gint>(height);
+    self->window_geometry.base_width = static_cast<gint>(base_width);
+    self->window_geometry.base_height = static_cast<gint>(base_height);
+    self->window_hints = static_cast<GdkWindowHints>(
+        self->window_hints | GDK_HINT_RESIZE_INC | GDK_HINT_BASE_SIZE);
+  } else {
+    self->window_hints = static_cast<GdkWindowHints>(
+        self->window_hints & ~(GDK_HINT_RESIZE_INC | GDK_HINT_BASE_SIZE));
+  }
+
+  apply_geometry_hints(self);
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+#ifdef WINDOW_MANAGER_ENABLE_BACKGROUND_COLOR
 static FlMethodResponse* set_background_color(WindowManagerPlugin* self,
                                               FlValue* args) {
   GdkRGBA rgba;
@@ -258,18 +1052,31 @@ static FlMethodResponse* set_background_color(WindowManagerPlugin* self,
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
+#endif
 
-static FlMethodResponse* get_bounds(WindowManagerPlugin* self) {
-  gint x, y, width, height;
-  gtk_window_get_position(get_window(self), &x, &y);
-  gtk_window_get_size(get_window(self), &width, &height);
+// Bounds include the frame drawn by the window manager, as on the other
+// platforms. gtk_window_get_position already returns the frame's origin.
+static GdkRectangle get_outer_bounds(WindowManagerPlugin* self) {
+  GdkRectangle bounds;
+  gtk_window_get_position(get_window(self), &bounds.x, &bounds.y);
+  gtk_window_get_size(get_window(self), &bounds.width, &bounds.height);
+  bounds.width += self->frame_extents.left + self->frame_extents.right;
+  bounds.height += self->frame_extents.top + self->frame_extents.bottom;
+  return bounds;
+}
 
-  g_autoptr(FlValue) result_data = fl_value_new_map();
-  fl_value_set_string_take(result_data, "x", fl_value_new_float(x));
-  fl_value_set_string_take(result_data, "y", fl_value_new_float(y));
-  fl_value_set_string_take(result_data, "width", fl_value_new_float(width));
-  fl_value_set_string_take(result_data, "height", fl_value_new_float(height));
+static void set_bounds_values(FlValue* map, const GdkRectangle* bounds) {
+  fl_value_set_string_take(map, "x", fl_value_new_float(bounds->x));
+  fl_value_set_string_take(map, "y", fl_value_new_float(bounds->y));
+  fl_value_set_string_take(map, "width", fl_value_new_float(bounds->width));
+  fl_value_set_string_take(map, "height",
+                           fl_value_new_float(bounds->height));
+}
 
+static FlMethodResponse* get_bounds(WindowManagerPlugin* self) {
+  GdkRectangle bounds = get_outer_bounds(self);
+  g_autoptr(FlValue) result_data = fl_value_new_map();
+  set_bounds_values(result_data, &bounds);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result_data));
 }
 
@@ -284,9 +1091,183 @@ static FlMethodResponse* set_bounds(WindowManagerPlugin* self, FlValue* args) {
   FlValue* width = fl_value_lookup_string(args, "width");
   FlValue* height = fl_value_lookup_string(args, "height");
   if (width != nullptr && height != nullptr) {
-    gtk_window_resize(get_window(self),
-                      static_cast<gint>(fl_value_get_float(width)),
-                      static_cast<gint>(fl_value_get_float(height)));
+    gtk_window_resize(
+        get_window(self),
+        static_cast<gint>(fl_value_get_float(width)) -
+            self->frame_extents.left - self->frame_extents.right,
+        static_cast<gint>(fl_value_get_float(height)) -
+            self->frame_extents.top - self->frame_extents.bottom);
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// The states in which the window does not have its own bounds, and returns
+// to the normal bounds when it leaves them.
+static constexpr guint kNonNormalWindowStates =
+    GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_MAXIMIZED |
+    GDK_WINDOW_STATE_FULLSCREEN | GDK_WINDOW_STATE_TILED;
+
+static guint get_window_state(WindowManagerPlugin* self) {
+  GdkWindow* window = get_gdk_window(self);
+  return window != nullptr ? gdk_window_get_state(window) : 0;
+}
+
+// Called on configure events, so that the normal bounds are known while the
+// window is maximized, fullscreen, minimized or tiled.
+static void update_normal_bounds(WindowManagerPlugin* self) {
+  if (get_window_state(self) & kNonNormalWindowStates)
+    return;
+  self->previous_normal_bounds = self->normal_bounds;
+  self->normal_bounds = get_outer_bounds(self);
+  self->_has_normal_bounds = true;
+}
+
+// Some window managers configure the window with its maximized or
+// fullscreen size before they update its state, which records that size as
+// the normal bounds. Undo that when the window leaves the normal state.
+static void on_normal_state_left(WindowManagerPlugin* self) {
+  GdkRectangle bounds = get_outer_bounds(self);
+  if (self->_has_normal_bounds &&
+      gdk_rectangle_equal(&self->normal_bounds, &bounds)) {
+    self->normal_bounds = self->previous_normal_bounds;
+  }
+}
+
+static gint get_monitor_index(GdkDisplay* display, GdkMonitor* monitor) {
+  for (gint i = 0; i < gdk_display_get_n_monitors(display); i++) {
+    if (gdk_display_get_monitor(display, i) == monitor)
+      return i;
+  }
+  return -1;
+}
+
+// Moves `bounds` into the workarea of the monitor numbered `monitor_index`,
+// or of the primary monitor, when it is not on any monitor anymore.
+static void ensure_on_monitor(GdkDisplay* display,
+                              gint monitor_index,
+                              GdkRectangle* bounds) {
+  gint n_monitors = gdk_display_get_n_monitors(display);
+  for (gint i = 0; i < n_monitors; i++) {
+    GdkRectangle workarea;
+    gdk_monitor_get_workarea(gdk_display_get_monitor(display, i), &workarea);
+    if (gdk_rectangle_intersect(bounds, &workarea, nullptr))
+      return;
+  }
+
+  GdkMonitor* monitor = monitor_index >= 0 && monitor_index < n_monitors
+                            ? gdk_display_get_monitor(display, monitor_index)
+                            : gdk_display_get_primary_monitor(display);
+  if (monitor == nullptr && n_monitors > 0)
+    monitor = gdk_display_get_monitor(display, 0);
+  if (monitor == nullptr)
+    return;
+
+  GdkRectangle workarea;
+  gdk_monitor_get_workarea(monitor, &workarea);
+  bounds->width = MIN(bounds->width, workarea.width);
+  bounds->height = MIN(bounds->height, workarea.height);
+  bounds->x = workarea.x + (workarea.width - bounds->width) / 2;
+  bounds->y = workarea.y + (workarea.height - bounds->height) / 2;
+}
+
+static FlMethodResponse* get_placement(WindowManagerPlugin* self) {
+  guint state = get_window_state(self);
+  GdkRectangle bounds = self->_has_normal_bounds ? self->normal_bounds
+                                                 : get_outer_bounds(self);
+
+  g_autoptr(FlValue) result_data = fl_value_new_map();
+  set_bounds_values(result_data, &bounds);
+
+  const gchar* placement_state = "normal";
+  if (state & GDK_WINDOW_STATE_ICONIFIED)
+    placement_state = "minimized";
+  else if (state & GDK_WINDOW_STATE_FULLSCREEN)
+    placement_state = "fullScreen";
+  else if (state & GDK_WINDOW_STATE_MAXIMIZED)
+    placement_state = "maximized";
+  fl_value_set_string_take(result_data, "state",
+                           fl_value_new_string(placement_state));
+
+  GdkDisplay* display = gtk_widget_get_display(GTK_WIDGET(get_window(self)));
+  GdkMonitor* monitor = gdk_display_get_monitor_at_point(
+      display, bounds.x + bounds.width / 2, bounds.y + bounds.height / 2);
+  fl_value_set_string_take(
+      result_data, "monitor",
+      fl_value_new_int(get_monitor_index(display, monitor)));
+
+#ifdef GDK_WINDOWING_X11
+  // Sticky windows are on all desktops and report 0xFFFFFFFF.
+  GdkWindow* gdk_window = get_gdk_window(self);
+  if (gdk_window != nullptr && GDK_IS_X11_WINDOW(gdk_window)) {
+    guint32 desktop = gdk_x11_window_get_desktop(gdk_window);
+    if (desktop != G_MAXUINT32) {
+      fl_value_set_string_take(result_data, "workspace",
+                               fl_value_new_int(desktop));
+    }
+  }
+#endif
+
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result_data));
+}
+
+// Restores the normal bounds, monitor, workspace and state in one call.
+// The window manager ignores the bounds requested for a maximized or
+// fullscreen window, so those states are left first and entered again
+// afterwards; all of the requests are flushed to it together.
+static FlMethodResponse* set_placement(WindowManagerPlugin* self,
+                                       FlValue* args) {
+  GtkWindow* window = get_window(self);
+  GdkRectangle bounds;
+  bounds.x = static_cast<gint>(
+      fl_value_get_float(fl_value_lookup_string(args, "x")));
+  bounds.y = static_cast<gint>(
+      fl_value_get_float(fl_value_lookup_string(args, "y")));
+  bounds.width = static_cast<gint>(
+      fl_value_get_float(fl_value_lookup_string(args, "width")));
+  bounds.height = static_cast<gint>(
+      fl_value_get_float(fl_value_lookup_string(args, "height")));
+  const gchar* state =
+      fl_value_get_string(fl_value_lookup_string(args, "state"));
+  FlValue* monitor = fl_value_lookup_string(args, "monitor");
+
+  ensure_on_monitor(gtk_widget_get_display(GTK_WIDGET(window)),
+                    monitor != nullptr ? fl_value_get_int(monitor) : -1,
+                    &bounds);
+
+  guint current_state = get_window_state(self);
+  if (current_state & GDK_WINDOW_STATE_FULLSCREEN)
+    gtk_window_unfullscreen(window);
+  if (current_state & GDK_WINDOW_STATE_MAXIMIZED)
+    gtk_window_unmaximize(window);
+
+  gtk_window_move(window, bounds.x, bounds.y);
+  gtk_window_resize(
+      window,
+      bounds.width - self->frame_extents.left - self->frame_extents.right,
+      bounds.height - self->frame_extents.top - self->frame_extents.bottom);
+  self->previous_normal_bounds = bounds;
+  self->normal_bounds = bounds;
+  self->_has_normal_bounds = true;
+
+#ifdef GDK_WINDOWING_X11
+  FlValue* workspace = fl_value_lookup_string(args, "workspace");
+  GdkWindow* gdk_window = get_gdk_window(self);
+  if (workspace != nullptr && gdk_window != nullptr &&
+      GDK_IS_X11_WINDOW(gdk_window)) {
+    gdk_x11_window_move_to_desktop(gdk_window, fl_value_get_int(workspace));
+  }
+#endif
+
+  if (g_strcmp0(state, "maximized") == 0) {
+    gtk_window_maximize(window);
+  } else if (g_strcmp0(state, "fullScreen") == 0) {
+    gtk_window_fullscreen(window);
+  } else if (g_strcmp0(state, "minimized") == 0) {
+    gtk_window_iconify(window);
+  } else if (current_state & GDK_WINDOW_STATE_ICONIFIED) {
+    gtk_window_deiconify(window);
   }
 
   g_autoptr(FlValue) result = fl_value_new_bool(true);
@@ -309,8 +1290,7 @@ static FlMethodResponse* set_minimum_size(WindowManagerPlugin* self,
         static_cast<GdkWindowHints>(self->window_hints & ~GDK_HINT_MIN_SIZE);
   }
 
-  gdk_window_set_geometry_hints(get_gdk_window(self), &self->window_geometry,
-                                self->window_hints);
+  apply_geometry_hints(self);
 
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
@@ -338,8 +1318,7 @@ static FlMethodResponse* set_maximum_size(WindowManagerPlugin* self,
   if (self->window_geometry.max_height < 0)
     self->window_geometry.max_height = G_MAXINT;
 
-  gdk_window_set_geometry_hints(get_gdk_window(self), &self->window_geometry,
-                                self->window_hints);
+  apply_geometry_hints(self);
 
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
@@ -492,14 +1471,340 @@ static GtkWidget* find_header_bar(GtkWidget* widget) {
   return nullptr;
 }
 
+static gboolean emit_frame_metrics_changed(gpointer user_data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(user_data);
+  self->frame_metrics_changed_source_id = 0;
+
+  FlValue* event_data = fl_value_new_map();
+  fl_value_set_string_take(event_data, "titleBarHeight",
+                           fl_value_new_int(self->title_bar_height));
+  const struct {
+    const gchar* name;
+    const GtkBorder* extents;
+  } borders[] = {
+      {"frameExtents", &self->frame_extents},
+      {"shadowExtents", &self->shadow_extents},
+  };
+  for (const auto& border : borders) {
+    FlValue* extents = fl_value_new_map();
+    fl_value_set_string_take(extents, "left",
+                             fl_value_new_int(border.extents->left));
+    fl_value_set_string_take(extents, "top",
+                             fl_value_new_int(border.extents->top));
+    fl_value_set_string_take(extents, "right",
+                             fl_value_new_int(border.extents->right));
+    fl_value_set_string_take(extents, "bottom",
+                             fl_value_new_int(border.extents->bottom));
+    fl_value_set_string_take(event_data, border.name, extents);
+  }
+  _emit_event_data(self, "frame-metrics-changed", event_data);
+  return G_SOURCE_REMOVE;
+}
+
+// Coalesces the changes of one main loop iteration into a single
+// frame-metrics-changed event.
+static void queue_frame_metrics_changed(WindowManagerPlugin* self) {
+  if (self->frame_metrics_changed_source_id == 0) {
+    self->frame_metrics_changed_source_id =
+        g_idle_add(emit_frame_metrics_changed, self);
+  }
+}
+
+static void update_title_bar_height(WindowManagerPlugin* self) {
+  gint title_bar_height = 0;
+  if (self->header_bar != nullptr &&
+      gtk_widget_get_visible(self->header_bar)) {
+    title_bar_height = gtk_widget_get_allocated_height(self->header_bar);
+  }
+  if (title_bar_height != self->title_bar_height) {
+    self->title_bar_height = title_bar_height;
+    queue_frame_metrics_changed(self);
+  }
+}
+
+static void on_header_bar_size_allocate(GtkWidget* widget,
+                                        GdkRectangle* allocation,
+                                        gpointer user_data) {
+  update_title_bar_height(WINDOW_MANAGER_PLUGIN(user_data));
+}
+
+static void on_header_bar_visible(GObject* object,
+                                  GParamSpec* pspec,
+                                  gpointer user_data) {
+  update_title_bar_height(WINDOW_MANAGER_PLUGIN(user_data));
+}
+
+static void track_header_bar(WindowManagerPlugin* self,
+                             GtkWidget* header_bar) {
+  if (self->header_bar == header_bar)
+    return;
+
+  if (self->header_bar != nullptr) {
+    g_signal_handlers_disconnect_by_data(self->header_bar, self);
+    g_object_remove_weak_pointer(
+        G_OBJECT(self->header_bar),
+        reinterpret_cast<gpointer*>(&self->header_bar));
+  }
+  self->header_bar = header_bar;
+  if (header_bar != nullptr) {
+    g_object_add_weak_pointer(G_OBJECT(header_bar),
+                              reinterpret_cast<gpointer*>(&self->header_bar));
+    g_signal_connect(header_bar, "size-allocate",
+                     G_CALLBACK(on_header_bar_size_allocate), self);
+    g_signal_connect(header_bar, "notify::visible",
+                     G_CALLBACK(on_header_bar_visible), self);
+  }
+  update_title_bar_height(self);
+}
+
 // Returns the window's header bar which is typically a GtkHeaderBar used as
-// GtkWindow::titlebar, or a HdyHeaderBar as HdyWindow granchild.
-static GtkWidget* get_header_bar(GtkWindow* window) {
-  GtkWidget* titlebar = gtk_window_get_titlebar(window);
-  if (is_header_bar(titlebar)) {
-    return titlebar;
+// GtkWindow::titlebar, or a HdyHeaderBar as HdyWindow granchild. The widget
+// tree is only searched the first time.
+static GtkWidget* get_cached_header_bar(WindowManagerPlugin* self) {
+  GtkWidget* titlebar = gtk_window_get_titlebar(get_window(self));
+  if (titlebar != self->header_bar && is_header_bar(titlebar)) {
+    track_header_bar(self, titlebar);
+  } else if (self->header_bar == nullptr && !self->_is_header_bar_searched) {
+    track_header_bar(self, find_header_bar(GTK_WIDGET(get_window(self))));
+  }
+  self->_is_header_bar_searched = true;
+  return self->header_bar;
+}
+
+// Reads a CARDINAL[4] left, right, top, bottom property such as
+// _NET_FRAME_EXTENTS of the window.
+static GtkBorder read_extents_property(WindowManagerPlugin* self,
+                                       const gchar* name) {
+  GtkBorder extents = {};
+#ifdef GDK_WINDOWING_X11
+  GdkWindow* window = get_gdk_window(self);
+  if (window == nullptr || !GDK_IS_X11_WINDOW(window))
+    return extents;
+
+  GdkAtom actual_type;
+  gint actual_format, actual_length;
+  guchar* data = nullptr;
+  if (gdk_property_get(window, gdk_atom_intern(name, false),
+                       gdk_atom_intern_static_string("CARDINAL"), 0, 4, false,
+                       &actual_type, &actual_format, &actual_length, &data)) {
+    // Format 32 properties are returned as longs.
+    if (actual_format == 32 && actual_length == 4 * sizeof(glong)) {
+      const glong* values = reinterpret_cast<const glong*>(data);
+      extents.left = values[0];
+      extents.right = values[1];
+      extents.top = values[2];
+      extents.bottom = values[3];
+    }
+    g_free(data);
+  }
+#endif
+  return extents;
+}
+
+static bool is_same_border(const GtkBorder* a, const GtkBorder* b) {
+  return a->left == b->left && a->right == b->right && a->top == b->top &&
+         a->bottom == b->bottom;
+}
+
+static void update_frame_extents(WindowManagerPlugin* self) {
+  GtkBorder frame_extents = read_extents_property(self, "_NET_FRAME_EXTENTS");
+  GtkBorder shadow_extents = read_extents_property(self, "_GTK_FRAME_EXTENTS");
+  if (!is_same_border(&frame_extents, &self->frame_extents) ||
+      !is_same_border(&shadow_extents, &self->shadow_extents)) {
+    self->frame_extents = frame_extents;
+    self->shadow_extents = shadow_extents;
+    apply_geometry_hints(self);
+    queue_frame_metrics_changed(self);
+  }
+}
+
+// The AppLifecycleState values in the format of the flutter/lifecycle
+// channel. The framework stops producing frames while hidden or paused.
+static constexpr char kLifecycleResumed[] = "AppLifecycleState.resumed";
+static constexpr char kLifecycleInactive[] = "AppLifecycleState.inactive";
+static constexpr char kLifecycleHidden[] = "AppLifecycleState.hidden";
+static constexpr char kLifecyclePaused[] = "AppLifecycleState.paused";
+
+static bool is_on_current_workspace(WindowManagerPlugin* self) {
+#ifdef GDK_WINDOWING_X11
+  GdkWindow* gdk_window = get_gdk_window(self);
+  if (gdk_window != nullptr && GDK_IS_X11_WINDOW(gdk_window)) {
+    // Sticky windows are on all desktops and report 0xFFFFFFFF.
+    guint32 desktop = gdk_x11_window_get_desktop(gdk_window);
+    return desktop == G_MAXUINT32 ||
+           desktop == gdk_x11_screen_get_current_desktop(
+                          gdk_window_get_screen(gdk_window));
+  }
+#endif
+  return true;
+}
+
+// Paused while the window is hidden with hide(), hidden while it is
+// minimized, unmapped or on another workspace, and inactive while another
+// window has the focus.
+static const gchar* get_lifecycle_state(WindowManagerPlugin* self) {
+  GtkWindow* window = get_window(self);
+  if (!gtk_widget_get_visible(GTK_WIDGET(window)))
+    return kLifecyclePaused;
+  if ((get_window_state(self) &
+       (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_WITHDRAWN)) ||
+      !is_on_current_workspace(self)) {
+    return kLifecycleHidden;
+  }
+  if (!gtk_window_is_active(window))
+    return kLifecycleInactive;
+  return kLifecycleResumed;
+}
+
+static void send_lifecycle_state(WindowManagerPlugin* self,
+                                 const gchar* state) {
+  g_autoptr(FlValue) message = fl_value_new_string(state);
+  fl_basic_message_channel_send(self->lifecycle_channel, message, nullptr,
+                                nullptr, nullptr);
+}
+
+// Sends the state even if it has not changed. FlView in Flutter 3.13 and
+// later sends its own state from window-state-event, so the last state the
+// framework received is not known here. The handlers are connected after
+// the engine's, so that the plugin's state is the one which sticks.
+static void update_lifecycle_state(WindowManagerPlugin* self) {
+  if (self->lifecycle_channel == nullptr)
+    return;
+
+  send_lifecycle_state(self, get_lifecycle_state(self));
+}
+
+static void on_lifecycle_notify(GObject* object,
+                                GParamSpec* pspec,
+                                gpointer user_data) {
+  update_lifecycle_state(WINDOW_MANAGER_PLUGIN(user_data));
+}
+
+static gboolean on_lifecycle_window_state(GtkWidget* widget,
+                                          GdkEventWindowState* event,
+                                          gpointer user_data) {
+  update_lifecycle_state(WINDOW_MANAGER_PLUGIN(user_data));
+  return false;
+}
+
+#ifdef GDK_WINDOWING_X11
+// Watches _NET_CURRENT_DESKTOP on the root window for workspace switches.
+static GdkFilterReturn on_root_property_filter(GdkXEvent* gdk_xevent,
+                                               GdkEvent* event,
+                                               gpointer user_data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(user_data);
+  XEvent* xevent = reinterpret_cast<XEvent*>(gdk_xevent);
+  if (xevent->type == PropertyNotify &&
+      xevent->xproperty.atom ==
+          gdk_x11_get_xatom_by_name_for_display(
+              gdk_window_get_display(self->lifecycle_root_window),
+              "_NET_CURRENT_DESKTOP")) {
+    update_lifecycle_state(self);
+  }
+  return GDK_FILTER_CONTINUE;
+}
+#endif
+
+static void start_lifecycle_reporting(WindowManagerPlugin* self) {
+  if (self->lifecycle_channel != nullptr)
+    return;
+
+  GtkWindow* window = get_window(self);
+  g_autoptr(FlStringCodec) codec = fl_string_codec_new();
+  self->lifecycle_channel = fl_basic_message_channel_new(
+      fl_plugin_registrar_get_messenger(self->registrar), "flutter/lifecycle",
+      FL_MESSAGE_CODEC(codec));
+  self->lifecycle_visible_handler_id =
+      g_signal_connect_after(window, "notify::visible",
+                             G_CALLBACK(on_lifecycle_notify), self);
+  self->lifecycle_active_handler_id =
+      g_signal_connect_after(window, "notify::is-active",
+                             G_CALLBACK(on_lifecycle_notify), self);
+  self->lifecycle_state_handler_id =
+      g_signal_connect_after(window, "window-state-event",
+                             G_CALLBACK(on_lifecycle_window_state), self);
+
+#ifdef GDK_WINDOWING_X11
+  GdkWindow* root_window =
+      gdk_screen_get_root_window(gtk_window_get_screen(window));
+  if (GDK_IS_X11_WINDOW(root_window)) {
+    self->lifecycle_root_window = root_window;
+    gdk_window_set_events(root_window, static_cast<GdkEventMask>(
+                                           gdk_window_get_events(root_window) |
+                                           GDK_PROPERTY_CHANGE_MASK));
+    gdk_window_add_filter(root_window, on_root_property_filter, self);
+  }
+#endif
+
+  update_lifecycle_state(self);
+}
+
+// Disconnects the handlers. If `send_resumed` is set, the framework is told
+// it may produce frames again; dispose does not, as the engine may already
+// be shutting down.
+static void stop_lifecycle_reporting(WindowManagerPlugin* self,
+                                     bool send_resumed) {
+  if (self->lifecycle_channel == nullptr)
+    return;
+
+  GtkWindow* window = get_window(self);
+  if (window != nullptr) {
+    g_clear_signal_handler(&self->lifecycle_visible_handler_id, window);
+    g_clear_signal_handler(&self->lifecycle_active_handler_id, window);
+    g_clear_signal_handler(&self->lifecycle_state_handler_id, window);
+  }
+  self->lifecycle_visible_handler_id = 0;
+  self->lifecycle_active_handler_id = 0;
+  self->lifecycle_state_handler_id = 0;
+#ifdef GDK_WINDOWING_X11
+  if (self->lifecycle_root_window != nullptr) {
+    gdk_window_remove_filter(self->lifecycle_root_window,
+                             on_root_property_filter, self);
+    self->lifecycle_root_window = nullptr;
+  }
+#endif
+
+  if (send_resumed)
+    send_lifecycle_state(self, kLifecycleResumed);
+  g_clear_object(&self->lifecycle_channel);
+}
+
+static FlMethodResponse* set_lifecycle_reporting(WindowManagerPlugin* self,
+                                                 FlValue* args) {
+  bool is_enabled =
+      fl_value_get_bool(fl_value_lookup_string(args, "isEnabled"));
+  if (is_enabled)
+    start_lifecycle_reporting(self);
+  else
+    stop_lifecycle_reporting(self, true);
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static gboolean on_window_property_notify(GtkWidget* widget,
+                                          GdkEventProperty* event,
+                                          gpointer user_data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(user_data);
+  if (event->atom == gdk_atom_intern_static_string("_NET_FRAME_EXTENTS") ||
+      event->atom == gdk_atom_intern_static_string("_GTK_FRAME_EXTENTS")) {
+    update_frame_extents(self);
+  } else if (event->atom == gdk_atom_intern_static_string("_NET_WM_DESKTOP")) {
+    update_lifecycle_state(self);
+  }
+  return false;
+}
+
+static void on_window_realize(GtkWidget* widget, gpointer user_data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(user_data);
+  update_frame_extents(self);
+  // Hints set before the window was realized had no GdkWindow to go to.
+  apply_geometry_hints(self);
+  // A new GdkWindow starts without the input shape of the previous one.
+  if (self->input_mask_region != nullptr) {
+    gdk_window_input_shape_combine_region(gtk_widget_get_window(widget),
+                                          self->input_mask_region, 0, 0);
   }
-  return find_header_bar(GTK_WIDGET(window));
 }
 
 static FlMethodResponse* set_title_bar_style(WindowManagerPlugin* self,
@@ -509,7 +1814,7 @@ static FlMethodResponse* set_title_bar_style(WindowManagerPlugin* self,
 
   gboolean normal = g_strcmp0(title_bar_style, "hidden") != 0;
 
-  GtkWidget* header_bar = get_header_bar(get_window(self));
+  GtkWidget* header_bar = get_cached_header_bar(self);
   if (header_bar != nullptr) {
     gtk_widget_set_visible(header_bar, normal);
   } else {
@@ -532,14 +1837,69 @@ static FlMethodResponse* set_title_bar_style(WindowManagerPlugin* self,
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+// Lets a native GtkHeaderBar draw the title and caption buttons, so hover,
+// press and drag are handled by GTK instead of being painted in Flutter.
+// Caption buttons are reported to Dart through the regular minimize,
+// maximize and close events.
+static FlMethodResponse* set_native_title_bar(WindowManagerPlugin* self,
+                                              FlValue* args) {
+  bool enabled = fl_value_get_bool(fl_value_lookup_string(args, "enabled"));
+  FlValue* height = fl_value_lookup_string(args, "height");
+  FlValue* decoration_layout = fl_value_lookup_string(args, "decorationLayout");
+
+  GtkWindow* window = get_window(self);
+  GtkWidget* header_bar = get_cached_header_bar(self);
+  if (header_bar == nullptr) {
+    if (!enabled) {
+      g_autoptr(FlValue) result = fl_value_new_bool(true);
+      return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
+
+    // GTK can only switch to client-side decorations before the window is
+    // realized. Runners that realize early must create the header bar.
+    if (gtk_widget_get_realized(GTK_WIDGET(window))) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "setNativeTitleBar",
+          "The window has no GtkHeaderBar and is already realized.", nullptr));
+    }
+    header_bar = gtk_header_bar_new();
+    gtk_window_set_titlebar(window, header_bar);
+    track_header_bar(self, header_bar);
+  }
+
+  if (GTK_IS_HEADER_BAR(header_bar)) {
+    gtk_header_bar_set_show_close_button(GTK_HEADER_BAR(header_bar), true);
+    if (decoration_layout != nullptr &&
+        fl_value_get_type(decoration_layout) == FL_VALUE_TYPE_STRING) {
+      gtk_header_bar_set_decoration_layout(
+          GTK_HEADER_BAR(header_bar), fl_value_get_string(decoration_layout));
+    }
+  }
+  if (height != nullptr) {
+    gtk_widget_set_size_request(header_bar, -1,
+                                static_cast<gint>(fl_value_get_float(height)));
+  }
+
+  gtk_widget_set_visible(header_bar, enabled);
+  if (enabled) {
+    gtk_window_set_decorated(window, true);
+  }
+
+  g_free(self->title_bar_style_);
+  self->title_bar_style_ = g_strdup(enabled ? "normal" : "hidden");
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
 static FlMethodResponse* get_title_bar_height(WindowManagerPlugin* self,
                                               FlValue* args) {
-  GtkWidget* widget = gtk_window_get_titlebar(get_window(self));
+  get_cached_header_bar(self);
 
   int title_bar_height = 0;
 
   if (g_strcmp0(self->title_bar_style_, "hidden") != 0) {
-    title_bar_height = gtk_widget_get_allocated_height(widget);
+    title_bar_height = self->title_bar_height;
   }
 
   g_autoptr(FlValue) result = fl_value_new_int(title_bar_height);
@@ -576,27 +1936,193 @@ static FlMethodResponse* get_opacity(WindowManagerPlugin* self) {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
-static FlMethodResponse* set_opacity(WindowManagerPlugin* self, FlValue* args) {
-  gdouble opacity = fl_value_get_float(fl_value_lookup_string(args, "opacity"));
-  gtk_widget_set_opacity(GTK_WIDGET(get_window(self)), opacity);
-  g_autoptr(FlValue) result = fl_value_new_bool(true);
-  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+typedef struct {
+  gint x;
+  gint width;
+} MaskRun;
+
+// Appends the runs of `row` whose alpha is at least `threshold` to `runs`.
+// Blocks of 16 pixels which are all inside or all outside the current run
+// are skipped with a single vector compare.
+static void scan_mask_row(const guint8* row,
+                          gint width,
+                          guint8 threshold,
+                          GArray* runs) {
+  gint run_start = -1;
+  auto step = [&](gint x, bool is_inside) {
+    if (is_inside && run_start < 0) {
+      run_start = x;
+    } else if (!is_inside && run_start >= 0) {
+      MaskRun run = {run_start, x - run_start};
+      g_array_append_val(runs, run);
+      run_start = -1;
+    }
+  };
+
+  gint x = 0;
+#if defined(__SSE2__)
+  const __m128i threshold_vector = _mm_set1_epi8(static_cast<char>(threshold));
+  for (; x + 16 <= width; x += 16) {
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+    // Unsigned pixels >= threshold.
+    int bits = _mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_max_epu8(pixels, threshold_vector), pixels));
+    if ((bits == 0xffff && run_start >= 0) || (bits == 0 && run_start < 0))
+      continue;
+    for (gint i = 0; i < 16; i++)
+      step(x + i, (bits >> i) & 1);
+  }
+#elif defined(__aarch64__)
+  const uint8x16_t threshold_vector = vdupq_n_u8(threshold);
+  for (; x + 16 <= width; x += 16) {
+    uint8x16_t is_inside = vcgeq_u8(vld1q_u8(row + x), threshold_vector);
+    if ((vminvq_u8(is_inside) == 0xff && run_start >= 0) ||
+        (vmaxvq_u8(is_inside) == 0 && run_start < 0)) {
+      continue;
+    }
+    for (gint i = 0; i < 16; i++)
+      step(x + i, row[x + i] >= threshold);
+  }
+#endif
+  for (; x < width; x++)
+    step(x, row[x] >= threshold);
+  step(width, false);
 }
 
-static FlMethodResponse* pop_up_window_menu(WindowManagerPlugin* self) {
+static void clear_input_mask(WindowManagerPlugin* self) {
+  g_clear_pointer(&self->input_mask, g_bytes_unref);
+  g_clear_pointer(&self->input_mask_runs, g_array_unref);
+  g_clear_pointer(&self->input_mask_row_starts, g_array_unref);
+  g_clear_pointer(&self->input_mask_region, cairo_region_destroy);
+}
+
+// Sets the input region of the window to the pixels of an 8-bit alpha mask
+// which are at least `threshold`, so that clicks elsewhere pass through.
+// Rows which did not change since the previous mask reuse its runs, and
+// equal adjacent rows are merged into one rectangle. The region is kept and
+// applied again whenever the window is realized.
+static FlMethodResponse* set_input_mask(WindowManagerPlugin* self,
+                                        FlValue* args) {
   GdkWindow* window = get_gdk_window(self);
-  GdkDisplay* display = gdk_display_get_default();
-  GdkSeat* seat = gdk_display_get_default_seat(display);
-  GdkDevice* pointer = gdk_seat_get_pointer(seat);
+  FlValue* mask_value = fl_value_lookup_string(args, "mask");
+  if (mask_value == nullptr ||
+      fl_value_get_type(mask_value) != FL_VALUE_TYPE_UINT8_LIST) {
+    clear_input_mask(self);
+    if (window != nullptr)
+      gdk_window_input_shape_combine_region(window, nullptr, 0, 0);
+    g_autoptr(FlValue) result = fl_value_new_int(0);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
 
-  int x, y;
-  gdk_device_get_position(pointer, NULL, &x, &y);
+  gint width = fl_value_get_int(fl_value_lookup_string(args, "width"));
+  gint height = fl_value_get_int(fl_value_lookup_string(args, "height"));
+  guint8 threshold = static_cast<guint8>(
+      fl_value_get_int(fl_value_lookup_string(args, "threshold")));
+  const guint8* mask = fl_value_get_uint8_list(mask_value);
+  if (width <= 0 || height <= 0 ||
+      fl_value_get_length(mask_value) < static_cast<size_t>(width) * height) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "setInputMask", "The mask is smaller than width * height.", nullptr));
+  }
 
-  int origin_x, origin_y;
-  gdk_window_get_origin(window, &origin_x, &origin_y);
+  gint64 start_time = g_get_monotonic_time();
+
+  // Only rows of a previous mask with the same layout can be reused.
+  const guint8* previous_mask = nullptr;
+  gint previous_height = 0;
+  if (self->input_mask != nullptr && self->input_mask_width == width &&
+      self->input_mask_threshold == threshold) {
+    gsize previous_size;
+    previous_mask = static_cast<const guint8*>(
+        g_bytes_get_data(self->input_mask, &previous_size));
+    previous_height = previous_size / width;
+  }
 
-  GdkEvent* event = gdk_event_new(GDK_BUTTON_PRESS);
-  event->button.window = window;
+  GArray* runs = g_array_new(false, false, sizeof(MaskRun));
+  GArray* row_starts = g_array_sized_new(false, false, sizeof(guint),
+                                         height + 1);
+  g_autoptr(GArray) rectangles =
+      g_array_new(false, false, sizeof(cairo_rectangle_int_t));
+  guint previous_row_rectangles = 0;
+  for (gint y = 0; y < height; y++) {
+    const guint8* row = mask + static_cast<gsize>(y) * width;
+    guint row_start = runs->len;
+    g_array_append_val(row_starts, row_start);
+    if (y < previous_height &&
+        memcmp(row, previous_mask + static_cast<gsize>(y) * width, width) ==
+            0) {
+      guint start = g_array_index(self->input_mask_row_starts, guint, y);
+      guint end = g_array_index(self->input_mask_row_starts, guint, y + 1);
+      g_array_append_vals(runs,
+                          &g_array_index(self->input_mask_runs, MaskRun, start),
+                          end - start);
+    } else {
+      scan_mask_row(row, width, threshold, runs);
+    }
+
+    // Extend the rectangles of the previous row when the runs are the same.
+    guint run_count = runs->len - row_start;
+    MaskRun* row_runs = &g_array_index(runs, MaskRun, row_start);
+    if (y > 0 && run_count > 0 && run_count == previous_row_rectangles) {
+      guint previous_start = g_array_index(row_starts, guint, y - 1);
+      if (memcmp(row_runs, &g_array_index(runs, MaskRun, previous_start),
+                 run_count * sizeof(MaskRun)) == 0) {
+        for (guint i = rectangles->len - run_count; i < rectangles->len; i++)
+          g_array_index(rectangles, cairo_rectangle_int_t, i).height++;
+        continue;
+      }
+    }
+    for (guint i = 0; i < run_count; i++) {
+      cairo_rectangle_int_t rectangle = {row_runs[i].x, y, row_runs[i].width,
+                                         1};
+      g_array_append_val(rectangles, rectangle);
+    }
+    previous_row_rectangles = run_count;
+  }
+  guint runs_end = runs->len;
+  g_array_append_val(row_starts, runs_end);
+
+  cairo_region_t* region = cairo_region_create_rectangles(
+      reinterpret_cast<cairo_rectangle_int_t*>(rectangles->data),
+      rectangles->len);
+  gint64 conversion_time = g_get_monotonic_time() - start_time;
+
+  if (window != nullptr)
+    gdk_window_input_shape_combine_region(window, region, 0, 0);
+
+  clear_input_mask(self);
+  self->input_mask = g_bytes_new(mask, static_cast<gsize>(width) * height);
+  self->input_mask_width = width;
+  self->input_mask_threshold = threshold;
+  self->input_mask_runs = runs;
+  self->input_mask_row_starts = row_starts;
+  self->input_mask_region = region;
+
+  g_autoptr(FlValue) result = fl_value_new_int(conversion_time);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* set_opacity(WindowManagerPlugin* self, FlValue* args) {
+  gdouble opacity = fl_value_get_float(fl_value_lookup_string(args, "opacity"));
+  gtk_widget_set_opacity(GTK_WIDGET(get_window(self)), opacity);
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* pop_up_window_menu(WindowManagerPlugin* self) {
+  GdkWindow* window = get_gdk_window(self);
+  GdkDisplay* display = gdk_display_get_default();
+  GdkSeat* seat = gdk_display_get_default_seat(display);
+  GdkDevice* pointer = gdk_seat_get_pointer(seat);
+
+  int x, y;
+  gdk_device_get_position(pointer, NULL, &x, &y);
+
+  int origin_x, origin_y;
+  gdk_window_get_origin(window, &origin_x, &origin_y);
+
+  GdkEvent* event = gdk_event_new(GDK_BUTTON_PRESS);
+  event->button.window = window;
   event->button.device = pointer;
   event->button.x_root = x;
   event->button.y_root = y;
@@ -608,6 +2134,265 @@ static FlMethodResponse* pop_up_window_menu(WindowManagerPlugin* self) {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+static const gchar* gdk_grab_status_code(GdkGrabStatus status) {
+  switch (status) {
+    case GDK_GRAB_SUCCESS:
+      return "GDK_GRAB_SUCCESS";
+    case GDK_GRAB_ALREADY_GRABBED:
+      return "GDK_GRAB_ALREADY_GRABBED";
+    case GDK_GRAB_INVALID_TIME:
+      return "GDK_GRAB_INVALID_TIME";
+    case GDK_GRAB_NOT_VIEWABLE:
+      return "GDK_GRAB_NOT_VIEWABLE";
+    case GDK_GRAB_FROZEN:
+      return "GDK_GRAB_FROZEN";
+    case GDK_GRAB_FAILED:
+      return "GDK_GRAB_FAILED";
+    default:
+      return "GDK_GRAB_???";
+  }
+}
+
+static const gchar* gdk_grab_status_message(GdkGrabStatus status) {
+  switch (status) {
+    case GDK_GRAB_SUCCESS:
+      return "The resource was successfully grabbed.";
+    case GDK_GRAB_ALREADY_GRABBED:
+      return "The resource is actively grabbed by another client.";
+    case GDK_GRAB_INVALID_TIME:
+      return "The resource was grabbed more recently than the specified time.";
+    case GDK_GRAB_NOT_VIEWABLE:
+      return "The grab window or the confine_to window are not viewable.";
+    case GDK_GRAB_FROZEN:
+      return "The resource is frozen by an active grab of another client.";
+    case GDK_GRAB_FAILED:
+      return "The grab failed for some other reason.";
+    default:
+      return "The grab status is unknown.";
+  }
+}
+
+static FlMethodResponse* set_drag_snapping(WindowManagerPlugin* self,
+                                           FlValue* args) {
+  self->_is_snapping =
+      fl_value_get_bool(fl_value_lookup_string(args, "enabled"));
+  FlValue* distance = fl_value_lookup_string(args, "distance");
+  if (distance != nullptr) {
+    self->snap_distance = static_cast<gint>(fl_value_get_float(distance));
+  }
+
+  // Sibling rectangles are sent as a flat [x, y, width, height, ...] list.
+  FlValue* targets = fl_value_lookup_string(args, "targets");
+  if (targets != nullptr &&
+      fl_value_get_type(targets) == FL_VALUE_TYPE_FLOAT_LIST) {
+    const double* values = fl_value_get_float_list(targets);
+    size_t length = fl_value_get_length(targets);
+    g_array_set_size(self->snap_targets, 0);
+    for (size_t i = 0; i + 3 < length; i += 4) {
+      GdkRectangle rect = {static_cast<gint>(values[i]),
+                           static_cast<gint>(values[i + 1]),
+                           static_cast<gint>(values[i + 2]),
+                           static_cast<gint>(values[i + 3])};
+      g_array_append_val(self->snap_targets, rect);
+    }
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// A seat holds a single grab, which gdk_seat_grab() replaces and
+// gdk_seat_ungrab() drops whole. The keyboard grab of grabKeyboard and the
+// pointer grab of lockPointer are therefore always made together from the
+// state of both, and made again once a snap drag, which needs its own
+// pointer grab, ends.
+static GdkGrabStatus update_seat_grab(WindowManagerPlugin* self,
+                                      bool keyboard,
+                                      bool pointer) {
+  GdkSeat* seat = gdk_display_get_default_seat(
+      gtk_widget_get_display(GTK_WIDGET(get_window(self))));
+  if (!keyboard && !pointer) {
+    gdk_seat_ungrab(seat);
+    return GDK_GRAB_SUCCESS;
+  }
+
+  GdkWindow* gdk_window = get_gdk_window(self);
+  if (gdk_window == nullptr)
+    return GDK_GRAB_NOT_VIEWABLE;
+
+  GdkSeatCapabilities capabilities = GDK_SEAT_CAPABILITY_NONE;
+  if (keyboard) {
+    capabilities = static_cast<GdkSeatCapabilities>(
+        capabilities | GDK_SEAT_CAPABILITY_KEYBOARD);
+  }
+  g_autoptr(GdkCursor) cursor = nullptr;
+  if (pointer) {
+    capabilities = static_cast<GdkSeatCapabilities>(
+        capabilities | GDK_SEAT_CAPABILITY_ALL_POINTING);
+    cursor = gdk_cursor_new_for_display(gdk_window_get_display(gdk_window),
+                                        GDK_BLANK_CURSOR);
+  }
+  return gdk_seat_grab(seat, gdk_window, capabilities,
+                       false /* owner_events */, cursor, nullptr /* event */,
+                       nullptr /* prepare_func */,
+                       nullptr /* prepare_func_data */);
+}
+
+// Snaps the edges [pos, pos + size) to whichever of edge_a or edge_b is
+// nearest, if it is closer than the best snap found so far.
+static void snap_edges(gint pos,
+                       gint size,
+                       gint edge_a,
+                       gint edge_b,
+                       gint* snapped,
+                       gint* best_delta) {
+  const gint edges[] = {edge_a, edge_b};
+  for (gint edge : edges) {
+    if (ABS(edge - pos) < *best_delta) {
+      *best_delta = ABS(edge - pos);
+      *snapped = edge;
+    }
+    if (ABS(edge - (pos + size)) < *best_delta) {
+      *best_delta = ABS(edge - (pos + size));
+      *snapped = edge - size;
+    }
+  }
+}
+
+// Returns the window position for the pointer position, snapped to the
+// monitor workarea edges and to the registered sibling rectangles.
+static void snap_position(WindowManagerPlugin* self,
+                          gint* x,
+                          gint* y,
+                          gint width,
+                          gint height) {
+  gint snapped_x = *x, snapped_y = *y;
+  gint best_dx = self->snap_distance + 1;
+  gint best_dy = self->snap_distance + 1;
+
+  GdkDisplay* display = gdk_window_get_display(get_gdk_window(self));
+  GdkMonitor* monitor =
+      gdk_display_get_monitor_at_point(display, *x + width / 2, *y);
+  if (monitor != nullptr) {
+    GdkRectangle workarea;
+    gdk_monitor_get_workarea(monitor, &workarea);
+    snap_edges(*x, width, workarea.x, workarea.x + workarea.width, &snapped_x,
+               &best_dx);
+    snap_edges(*y, height, workarea.y, workarea.y + workarea.height,
+               &snapped_y, &best_dy);
+  }
+
+  for (guint i = 0; i < self->snap_targets->len; i++) {
+    GdkRectangle* rect = &g_array_index(self->snap_targets, GdkRectangle, i);
+    // Only snap to a sibling edge when the windows are next to each other.
+    if (*y < rect->y + rect->height + self->snap_distance &&
+        *y + height > rect->y - self->snap_distance) {
+      snap_edges(*x, width, rect->x, rect->x + rect->width, &snapped_x,
+                 &best_dx);
+    }
+    if (*x < rect->x + rect->width + self->snap_distance &&
+        *x + width > rect->x - self->snap_distance) {
+      snap_edges(*y, height, rect->y, rect->y + rect->height, &snapped_y,
+                 &best_dy);
+    }
+  }
+
+  *x = snapped_x;
+  *y = snapped_y;
+}
+
+void emit_button_release(WindowManagerPlugin* self);
+
+static void end_snap_dragging(WindowManagerPlugin* self) {
+  GtkWindow* window = get_window(self);
+  g_clear_signal_handler(&self->snap_motion_handler_id, window);
+  g_clear_signal_handler(&self->snap_release_handler_id, window);
+  self->_is_snap_dragging = false;
+  update_seat_grab(self, self->grab_pointer != nullptr,
+                   self->_is_pointer_locked);
+
+  // Flutter never sees the release which ended the drag.
+  if (self->_event_box != nullptr) {
+    emit_button_release(self);
+  }
+
+  // "move" is held back during the drag, so report the final position once.
+  _emit_event(self, "move");
+  gint x, y;
+  gtk_window_get_position(window, &x, &y);
+  FlValue* event_data = fl_value_new_map();
+  fl_value_set_string_take(event_data, "x", fl_value_new_float(x));
+  fl_value_set_string_take(event_data, "y", fl_value_new_float(y));
+  _emit_event_data(self, "moved", event_data);
+}
+
+gboolean on_snap_drag_motion(GtkWidget* widget,
+                             GdkEventMotion* event,
+                             gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+  if (!(event->state & GDK_BUTTON1_MASK)) {
+    end_snap_dragging(self);
+    return TRUE;
+  }
+
+  // Snap the frame of the window manager too, not just the client area.
+  GdkRectangle bounds = get_outer_bounds(self);
+  gint x = static_cast<gint>(event->x_root) - self->drag_offset_x;
+  gint y = static_cast<gint>(event->y_root) - self->drag_offset_y;
+  snap_position(self, &x, &y, bounds.width, bounds.height);
+  gtk_window_move(get_window(self), x, y);
+  return TRUE;
+}
+
+gboolean on_snap_drag_release(GtkWidget* widget,
+                              GdkEventButton* event,
+                              gpointer data) {
+  end_snap_dragging(WINDOW_MANAGER_PLUGIN(data));
+  return TRUE;
+}
+
+// Runs the move loop in the plugin instead of the window manager, so that
+// the window can be snapped while it is being dragged.
+static FlMethodResponse* start_snap_dragging(WindowManagerPlugin* self,
+                                             GdkDevice* device,
+                                             gint root_x,
+                                             gint root_y) {
+  GtkWindow* window = get_window(self);
+  // Keep the keyboard grabbed for the accelerators of grabKeyboard.
+  GdkSeatCapabilities capabilities = GDK_SEAT_CAPABILITY_ALL_POINTING;
+  if (self->grab_pointer != nullptr) {
+    capabilities = static_cast<GdkSeatCapabilities>(
+        capabilities | GDK_SEAT_CAPABILITY_KEYBOARD);
+  }
+  GdkGrabStatus status = gdk_seat_grab(
+      gdk_device_get_seat(device), get_gdk_window(self), capabilities,
+      false /* owner_events */, nullptr /* cursor */, nullptr /* event */,
+      nullptr /* prepare_func */, nullptr /* prepare_func_data */);
+  if (status != GDK_GRAB_SUCCESS) {
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new(gdk_grab_status_code(status),
+                                     gdk_grab_status_message(status), nullptr));
+  }
+
+  gint x, y;
+  gtk_window_get_position(window, &x, &y);
+  self->drag_offset_x = root_x - x;
+  self->drag_offset_y = root_y - y;
+  self->_is_snap_dragging = true;
+
+  gtk_widget_add_events(GTK_WIDGET(window),
+                        GDK_POINTER_MOTION_MASK | GDK_BUTTON_RELEASE_MASK);
+  self->snap_motion_handler_id =
+      g_signal_connect(window, "motion-notify-event",
+                       G_CALLBACK(on_snap_drag_motion), self);
+  self->snap_release_handler_id =
+      g_signal_connect(window, "button-release-event",
+                       G_CALLBACK(on_snap_drag_release), self);
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
 static FlMethodResponse* start_dragging(WindowManagerPlugin* self) {
   auto window = get_window(self);
   auto screen = gtk_window_get_screen(window);
@@ -619,6 +2404,10 @@ static FlMethodResponse* start_dragging(WindowManagerPlugin* self) {
   gdk_device_get_position(device, nullptr, &root_x, &root_y);
   guint32 timestamp = (guint32)g_get_monotonic_time();
 
+  if (self->_is_snapping && !self->_is_snap_dragging) {
+    return start_snap_dragging(self, device, root_x, root_y);
+  }
+
   gtk_window_begin_move_drag(window, 1, root_x, root_y, timestamp);
   self->_is_dragging = true;
 
@@ -691,44 +2480,7 @@ static FlMethodResponse* start_resizing(WindowManagerPlugin* self,
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
-static const gchar* gdk_grab_status_code(GdkGrabStatus status) {
-  switch (status) {
-    case GDK_GRAB_SUCCESS:
-      return "GDK_GRAB_SUCCESS";
-    case GDK_GRAB_ALREADY_GRABBED:
-      return "GDK_GRAB_ALREADY_GRABBED";
-    case GDK_GRAB_INVALID_TIME:
-      return "GDK_GRAB_INVALID_TIME";
-    case GDK_GRAB_NOT_VIEWABLE:
-      return "GDK_GRAB_NOT_VIEWABLE";
-    case GDK_GRAB_FROZEN:
-      return "GDK_GRAB_FROZEN";
-    case GDK_GRAB_FAILED:
-      return "GDK_GRAB_FAILED";
-    default:
-      return "GDK_GRAB_???";
-  }
-}
-
-static const gchar* gdk_grab_status_message(GdkGrabStatus status) {
-  switch (status) {
-    case GDK_GRAB_SUCCESS:
-      return "The resource was successfully grabbed.";
-    case GDK_GRAB_ALREADY_GRABBED:
-      return "The resource is actively grabbed by another client.";
-    case GDK_GRAB_INVALID_TIME:
-      return "The resource was grabbed more recently than the specified time.";
-    case GDK_GRAB_NOT_VIEWABLE:
-      return "The grab window or the confine_to window are not viewable.";
-    case GDK_GRAB_FROZEN:
-      return "The resource is frozen by an active grab of another client.";
-    case GDK_GRAB_FAILED:
-      return "The grab failed for some other reason.";
-    default:
-      return "The grab status is unknown.";
-  }
-}
-
+#ifdef WINDOW_MANAGER_ENABLE_GRABS
 static GdkGrabStatus gdk_grab_keyboard(WindowManagerPlugin* self) {
   g_return_val_if_fail(self->grab_pointer == nullptr, GDK_GRAB_FAILED);
 
@@ -736,12 +2488,12 @@ static GdkGrabStatus gdk_grab_keyboard(WindowManagerPlugin* self) {
   auto screen = gtk_window_get_screen(window);
   auto display = gdk_screen_get_display(screen);
   auto seat = gdk_display_get_default_seat(display);
-  auto gdk_window = get_gdk_window(self);
 
-  GdkGrabStatus status = gdk_seat_grab(
-      seat, gdk_window, GDK_SEAT_CAPABILITY_KEYBOARD, false /* owner_events */,
-      nullptr /* cursor */, nullptr /* event */, nullptr /*prepare_func */,
-      nullptr /* prepare_func_data */);
+  // Keeps a locked pointer grabbed, since the grab replaces the seat's.
+  GdkGrabStatus status =
+      update_seat_grab(self, true, self->_is_pointer_locked);
+  if (status != GDK_GRAB_SUCCESS)
+    return status;
 
   self->grab_pointer = gdk_seat_get_keyboard(seat);
   if (!self->grab_pointer) {
@@ -751,7 +2503,181 @@ static GdkGrabStatus gdk_grab_keyboard(WindowManagerPlugin* self) {
   return status;
 }
 
-static FlMethodResponse* grab_keyboard(WindowManagerPlugin* self) {
+typedef enum {
+  kAcceleratorActionNotify,
+  kAcceleratorActionHide,
+  kAcceleratorActionShow,
+  kAcceleratorActionUngrab,
+} AcceleratorAction;
+
+typedef struct {
+  AcceleratorAction action;
+  gchar* id;
+} Accelerator;
+
+static void accelerator_free(Accelerator* accelerator) {
+  g_free(accelerator->id);
+  g_free(accelerator);
+}
+
+// Accelerators are keyed by their lower case keyval in the low 32 bits and
+// their modifiers in the high 32 bits.
+static gint64* accelerator_key_new(guint keyval, GdkModifierType modifiers) {
+  gint64* key = g_new(gint64, 1);
+  *key = static_cast<gint64>(
+      (static_cast<guint64>(modifiers) << 32) | gdk_keyval_to_lower(keyval));
+  return key;
+}
+
+// Normalizes modifiers the way GtkAccelGroup does. The virtual modifiers
+// from gtk_accelerator_parse, such as <Super>, and the real ones of key
+// events are both mapped to the same set, and lock modifiers such as
+// CapsLock and NumLock are ignored.
+static GdkModifierType normalize_modifiers(GdkKeymap* keymap,
+                                           GdkModifierType modifiers) {
+  gdk_keymap_map_virtual_modifiers(keymap, &modifiers);
+  gdk_keymap_add_virtual_modifiers(keymap, &modifiers);
+  return static_cast<GdkModifierType>(
+      modifiers & gtk_accelerator_get_default_mod_mask());
+}
+
+static Accelerator* find_accelerator(WindowManagerPlugin* self,
+                                     guint keyval,
+                                     GdkModifierType modifiers) {
+  g_autofree gint64* key = accelerator_key_new(keyval, modifiers);
+  return static_cast<Accelerator*>(
+      g_hash_table_lookup(self->accelerators, key));
+}
+
+static void clear_accelerators(WindowManagerPlugin* self) {
+  if (self->accelerator_handler_id != 0) {
+    g_signal_handler_disconnect(get_window(self), self->accelerator_handler_id);
+    self->accelerator_handler_id = 0;
+  }
+  g_clear_pointer(&self->accelerators, g_hash_table_unref);
+}
+
+static FlMethodResponse* ungrab_keyboard(WindowManagerPlugin* self);
+
+// Connected to the generic event signal, which is emitted before
+// key-press-event, so that accelerators are matched before Flutter sees the
+// key.
+static gboolean on_accelerator_event(GtkWidget* widget,
+                                     GdkEvent* event,
+                                     gpointer user_data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(user_data);
+  if (self->grab_pointer == nullptr || event->type != GDK_KEY_PRESS)
+    return false;
+
+  GdkKeymap* keymap =
+      gdk_keymap_get_for_display(gdk_window_get_display(event->key.window));
+  GdkModifierType state = static_cast<GdkModifierType>(event->key.state);
+  GdkModifierType consumed;
+  if (!gdk_keymap_translate_keyboard_state(keymap, event->key.hardware_keycode,
+                                           state, event->key.group, nullptr,
+                                           nullptr, nullptr, &consumed)) {
+    consumed = static_cast<GdkModifierType>(0);
+  }
+  GdkModifierType modifiers = normalize_modifiers(keymap, state);
+  consumed = normalize_modifiers(keymap, consumed);
+
+  // Match accelerators which name the modifiers used to produce the keyval,
+  // such as <Control><Shift>a, then ones which do not, such as
+  // <Control>exclam for Control+Shift+1.
+  Accelerator* accelerator =
+      find_accelerator(self, event->key.keyval, modifiers);
+  if (accelerator == nullptr && (modifiers & consumed) != 0) {
+    accelerator = find_accelerator(
+        self, event->key.keyval,
+        static_cast<GdkModifierType>(modifiers & ~consumed));
+  }
+  if (accelerator == nullptr)
+    return false;
+
+  // Ungrabbing frees the accelerator.
+  g_autofree gchar* id = g_strdup(accelerator->id);
+  switch (accelerator->action) {
+    case kAcceleratorActionHide:
+      hide_window(self);
+      break;
+    case kAcceleratorActionShow:
+      gtk_window_present(get_window(self));
+      break;
+    case kAcceleratorActionUngrab: {
+      g_autoptr(FlMethodResponse) response = ungrab_keyboard(self);
+      break;
+    }
+    case kAcceleratorActionNotify:
+      break;
+  }
+
+  if (id != nullptr) {
+    FlValue* event_data = fl_value_new_map();
+    fl_value_set_string_take(event_data, "id", fl_value_new_string(id));
+    _emit_event_data(self, "accelerator", event_data);
+  }
+  return true;
+}
+
+// Builds the table of accelerators matched natively while the keyboard is
+// grabbed, from a list of {accelerator, action, id} maps where accelerator
+// is in the format of gtk_accelerator_parse.
+static void set_accelerators(WindowManagerPlugin* self, FlValue* list) {
+  clear_accelerators(self);
+  if (list == nullptr || fl_value_get_type(list) != FL_VALUE_TYPE_LIST ||
+      fl_value_get_length(list) == 0) {
+    return;
+  }
+
+  GdkKeymap* keymap = gdk_keymap_get_for_display(
+      gtk_widget_get_display(GTK_WIDGET(get_window(self))));
+  self->accelerators =
+      g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free,
+                            reinterpret_cast<GDestroyNotify>(accelerator_free));
+  for (size_t i = 0; i < fl_value_get_length(list); i++) {
+    FlValue* entry = fl_value_get_list_value(list, i);
+    if (!has_args("accelerator:s action:s id?:s", entry, nullptr)) {
+      g_warning("Invalid accelerator entry %zu", i);
+      continue;
+    }
+    const gchar* name =
+        fl_value_get_string(fl_value_lookup_string(entry, "accelerator"));
+    const gchar* action =
+        fl_value_get_string(fl_value_lookup_string(entry, "action"));
+    FlValue* id = fl_value_lookup_string(entry, "id");
+
+    guint keyval;
+    GdkModifierType modifiers;
+    gtk_accelerator_parse(name, &keyval, &modifiers);
+    if (keyval == 0) {
+      g_warning("Invalid accelerator: %s", name);
+      continue;
+    }
+
+    Accelerator* accelerator = g_new0(Accelerator, 1);
+    if (g_strcmp0(action, "hide") == 0)
+      accelerator->action = kAcceleratorActionHide;
+    else if (g_strcmp0(action, "show") == 0)
+      accelerator->action = kAcceleratorActionShow;
+    else if (g_strcmp0(action, "ungrab") == 0)
+      accelerator->action = kAcceleratorActionUngrab;
+    else
+      accelerator->action = kAcceleratorActionNotify;
+    if (id != nullptr && fl_value_get_type(id) == FL_VALUE_TYPE_STRING)
+      accelerator->id = g_strdup(fl_value_get_string(id));
+    g_hash_table_insert(
+        self->accelerators,
+        accelerator_key_new(keyval, normalize_modifiers(keymap, modifiers)),
+        accelerator);
+  }
+
+  self->accelerator_handler_id =
+      g_signal_connect(get_window(self), "event",
+                       G_CALLBACK(on_accelerator_event), self);
+}
+
+static FlMethodResponse* grab_keyboard(WindowManagerPlugin* self,
+                                       FlValue* args) {
   GdkGrabStatus status = gdk_grab_keyboard(self);
 
   if (status != GDK_GRAB_SUCCESS) {
@@ -760,20 +2686,262 @@ static FlMethodResponse* grab_keyboard(WindowManagerPlugin* self) {
                                      gdk_grab_status_message(status), nullptr));
   }
 
+  set_accelerators(self, fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                             ? fl_value_lookup_string(args, "accelerators")
+                             : nullptr);
+
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
 static FlMethodResponse* ungrab_keyboard(WindowManagerPlugin* self) {
   if (self->grab_pointer != nullptr) {
-    gdk_seat_ungrab(gdk_device_get_seat(self->grab_pointer));
     self->grab_pointer = nullptr;
+    // Only releases the keyboard while the pointer is locked, so that
+    // on_locked_pointer_motion does not warp a pointer it no longer grabs.
+    update_seat_grab(self, false, self->_is_pointer_locked);
   }
+  clear_accelerators(self);
 
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+// Sends the pointer motion accumulated since the last frame as one event.
+static gboolean on_pointer_motion_tick(GtkWidget* widget,
+                                       GdkFrameClock* frame_clock,
+                                       gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+  self->pointer_motion_tick_id = 0;
+
+  if (self->pointer_motion_count > 0) {
+    FlValue* event_data = fl_value_new_map();
+    fl_value_set_string_take(event_data, "dx",
+                             fl_value_new_float(self->pointer_delta_x));
+    fl_value_set_string_take(event_data, "dy",
+                             fl_value_new_float(self->pointer_delta_y));
+    fl_value_set_string_take(event_data, "count",
+                             fl_value_new_int(self->pointer_motion_count));
+    _emit_event_data(self, "pointer-motion", event_data);
+  }
+
+  self->pointer_delta_x = 0;
+  self->pointer_delta_y = 0;
+  self->pointer_motion_count = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void accumulate_pointer_motion(WindowManagerPlugin* self,
+                                      gdouble dx,
+                                      gdouble dy) {
+  self->pointer_delta_x += dx;
+  self->pointer_delta_y += dy;
+  self->pointer_motion_count++;
+
+  if (self->pointer_motion_tick_id == 0) {
+    self->pointer_motion_tick_id = gtk_widget_add_tick_callback(
+        GTK_WIDGET(get_window(self)), on_pointer_motion_tick, self, nullptr);
+  }
+}
+
+// Moves the pointer back to the center of the window so that it never
+// reaches the screen edges.
+static void warp_pointer_to_center(WindowManagerPlugin* self,
+                                   GdkDevice* device) {
+  GdkWindow* gdk_window = get_gdk_window(self);
+  gint origin_x, origin_y;
+  gdk_window_get_origin(gdk_window, &origin_x, &origin_y);
+  gint center_x = origin_x + gdk_window_get_width(gdk_window) / 2;
+  gint center_y = origin_y + gdk_window_get_height(gdk_window) / 2;
+
+  gdk_device_warp(device, gdk_window_get_screen(gdk_window), center_x,
+                  center_y);
+  self->pointer_last_x = center_x;
+  self->pointer_last_y = center_y;
+}
+
+#if defined(GDK_WINDOWING_X11) && defined(WINDOW_MANAGER_HAS_XI2)
+// Receives XI_RawMotion events, which report unaccelerated device deltas
+// that are not clamped at the screen edges.
+static GdkFilterReturn on_raw_motion_filter(GdkXEvent* gdk_xevent,
+                                            GdkEvent* event,
+                                            gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+  XGenericEventCookie* cookie =
+      &(reinterpret_cast<XEvent*>(gdk_xevent))->xcookie;
+  if (cookie->type != GenericEvent || cookie->extension != self->xi_opcode ||
+      cookie->evtype != XI_RawMotion || cookie->data == nullptr) {
+    return GDK_FILTER_CONTINUE;
+  }
+
+  XIRawEvent* raw_event = static_cast<XIRawEvent*>(cookie->data);
+  const double* values = raw_event->raw_values;
+  gdouble dx = 0, dy = 0;
+  for (int i = 0; i < raw_event->valuators.mask_len * 8; i++) {
+    if (!XIMaskIsSet(raw_event->valuators.mask, i))
+      continue;
+    if (i == 0)
+      dx = *values;
+    else if (i == 1)
+      dy = *values;
+    values++;
+  }
+
+  if (dx != 0 || dy != 0) {
+    accumulate_pointer_motion(self, dx, dy);
+  }
+  return GDK_FILTER_CONTINUE;
+}
+#endif
+
+// Selects raw motion events on the root window. Returns false when raw
+// events are unavailable without XInput 2.
+static bool select_raw_motion(WindowManagerPlugin* self, bool enable) {
+#if defined(GDK_WINDOWING_X11) && defined(WINDOW_MANAGER_HAS_XI2)
+  GdkWindow* gdk_window = get_gdk_window(self);
+  GdkDisplay* display = gdk_window != nullptr
+                            ? gdk_window_get_display(gdk_window)
+                            : gdk_display_get_default();
+  if (!GDK_IS_X11_DISPLAY(display))
+    return false;
+
+  Display* xdisplay = GDK_DISPLAY_XDISPLAY(display);
+  int event_base, error_base;
+  if (!XQueryExtension(xdisplay, "XInputExtension", &self->xi_opcode,
+                       &event_base, &error_base)) {
+    return false;
+  }
+
+  unsigned char mask_bits[XIMaskLen(XI_LASTEVENT)] = {0};
+  XIEventMask mask;
+  mask.deviceid = XIAllMasterDevices;
+  mask.mask_len = sizeof(mask_bits);
+  mask.mask = mask_bits;
+  if (enable)
+    XISetMask(mask_bits, XI_RawMotion);
+  XISelectEvents(xdisplay, DefaultRootWindow(xdisplay), &mask, 1);
+  XFlush(xdisplay);
+
+  if (enable)
+    gdk_window_add_filter(nullptr, on_raw_motion_filter, self);
+  else
+    gdk_window_remove_filter(nullptr, on_raw_motion_filter, self);
+  return true;
+#else
+  return false;
+#endif
+}
+
+gboolean on_locked_pointer_motion(GtkWidget* widget,
+                                  GdkEventMotion* event,
+                                  gpointer data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(data);
+
+  // Without raw events, derive the deltas from the pointer position.
+  if (!self->_is_raw_motion) {
+    gdouble dx = event->x_root - self->pointer_last_x;
+    gdouble dy = event->y_root - self->pointer_last_y;
+    self->pointer_last_x = event->x_root;
+    self->pointer_last_y = event->y_root;
+    if (dx != 0 || dy != 0) {
+      accumulate_pointer_motion(self, dx, dy);
+    }
+  }
+
+  warp_pointer_to_center(self, gdk_event_get_device((GdkEvent*)event));
+  return TRUE;
+}
+
+static FlMethodResponse* lock_pointer(WindowManagerPlugin* self) {
+  if (self->_is_pointer_locked) {
+    g_autoptr(FlValue) result = fl_value_new_bool(true);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+
+  auto gdk_window = get_gdk_window(self);
+  auto display = gdk_window_get_display(gdk_window);
+  auto seat = gdk_display_get_default_seat(display);
+
+  // Unbounded relative motion needs either warping the pointer or raw
+  // events, which only X11 offers. On Wayland that takes the relative
+  // pointer and pointer constraints protocols, which are not bound here, so
+  // fail rather than report deltas which stop at the screen edges.
+#ifdef GDK_WINDOWING_X11
+  bool is_x11 = GDK_IS_X11_DISPLAY(display);
+#else
+  bool is_x11 = false;
+#endif
+  if (!is_x11) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "unsupported", "lockPointer is only supported on X11.", nullptr));
+  }
+
+  // Keeps the keyboard grabbed if grabKeyboard was called before.
+  GdkGrabStatus status =
+      update_seat_grab(self, self->grab_pointer != nullptr, true);
+
+  if (status != GDK_GRAB_SUCCESS) {
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new(gdk_grab_status_code(status),
+                                     gdk_grab_status_message(status), nullptr));
+  }
+
+  self->_is_pointer_locked = true;
+  self->pointer_delta_x = 0;
+  self->pointer_delta_y = 0;
+  self->pointer_motion_count = 0;
+  self->_is_raw_motion = select_raw_motion(self, true);
+  warp_pointer_to_center(self, gdk_seat_get_pointer(seat));
+
+  gtk_widget_add_events(GTK_WIDGET(get_window(self)),
+                        GDK_POINTER_MOTION_MASK);
+  self->pointer_motion_handler_id =
+      g_signal_connect(get_window(self), "motion-notify-event",
+                       G_CALLBACK(on_locked_pointer_motion), self);
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* unlock_pointer(WindowManagerPlugin* self) {
+  if (self->_is_pointer_locked) {
+    if (self->_is_raw_motion) {
+      select_raw_motion(self, false);
+      self->_is_raw_motion = false;
+    }
+    g_clear_signal_handler(&self->pointer_motion_handler_id, get_window(self));
+    if (self->pointer_motion_tick_id != 0) {
+      gtk_widget_remove_tick_callback(GTK_WIDGET(get_window(self)),
+                                      self->pointer_motion_tick_id);
+      self->pointer_motion_tick_id = 0;
+    }
+
+    self->_is_pointer_locked = false;
+    // Keeps the keyboard grabbed if grabKeyboard was called before.
+    update_seat_grab(self, self->grab_pointer != nullptr, false);
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+#endif
+
+#ifdef WINDOW_MANAGER_ENABLE_BRIGHTNESS
+// Returns whether the desktop prefers a dark color scheme, using the
+// org.freedesktop.appearance portal setting when it is available and the
+// GTK theme name otherwise. gtk-application-prefer-dark-theme is not read,
+// since it is the app's own setting, which setBrightness writes.
+static bool is_system_dark(WindowManagerPlugin* self) {
+  if (self->portal_color_scheme > 0) {
+    return self->portal_color_scheme == 1;
+  }
+
+  g_autofree gchar* theme_name = nullptr;
+  g_object_get(gtk_settings_get_default(), "gtk-theme-name", &theme_name,
+               nullptr);
+  return theme_name != nullptr && g_str_has_suffix(theme_name, "-dark");
+}
+
 static FlMethodResponse* set_brightness(WindowManagerPlugin* self,
                                         FlValue* args) {
   const gchar* brightness =
@@ -781,8 +2949,19 @@ static FlMethodResponse* set_brightness(WindowManagerPlugin* self,
 
   gboolean dark = g_strcmp0(brightness, "dark") == 0;
 
+  // Every GtkSettings change restyles the whole application, so only touch
+  // the settings which actually differ from the requested brightness.
   GtkSettings* settings = gtk_settings_get_default();
-  g_object_set(settings, "gtk-application-prefer-dark-theme", dark, nullptr);
+  gboolean prefer_dark_theme = false;
+  g_object_get(settings, "gtk-application-prefer-dark-theme",
+               &prefer_dark_theme, nullptr);
+
+  // Changes made here are not system brightness changes.
+  self->_is_setting_brightness = true;
+
+  if (prefer_dark_theme != dark) {
+    g_object_set(settings, "gtk-application-prefer-dark-theme", dark, nullptr);
+  }
 
   if (!dark) {
     // `gtk-application-prefer-dark-theme=false` is not enough to switch to the
@@ -798,10 +2977,322 @@ static FlMethodResponse* set_brightness(WindowManagerPlugin* self,
     }
   }
 
+  self->_is_setting_brightness = false;
+  // The theme name may have changed, which is not a system change either.
+  self->_is_dark = is_system_dark(self);
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+#endif
+
+// The main loop monitor runs a heartbeat at G_PRIORITY_LOW and records how
+// late each beat is dispatched, which is how long the main loop was kept
+// busy by everything else.
+static gboolean on_main_loop_heartbeat(gpointer user_data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(user_data);
+
+  gint64 now = g_get_monotonic_time();
+  gint64 lag =
+      MAX(now - self->main_loop_last_tick - self->main_loop_interval, 0);
+  self->main_loop_last_tick = now;
+
+  // Bucket i counts lags in [2^i, 2^(i+1)) microseconds.
+  guint bucket = lag > 0 ? g_bit_storage(lag) - 1 : 0;
+  bucket = MIN(bucket, G_N_ELEMENTS(self->main_loop_lag_histogram) - 1);
+  self->main_loop_lag_histogram[bucket]++;
+  self->main_loop_ticks++;
+  self->main_loop_max_lag = MAX(self->main_loop_max_lag, lag);
+
+  if (lag > self->main_loop_stall_threshold) {
+    self->main_loop_stalls++;
+    write_flight_record(kFlightRecordSignal, "main-loop-stall", now - lag,
+                        lag, 0, FLIGHT_RECORD_SLOW);
+    if (self->_is_emitting_main_loop_stalls) {
+      FlValue* event_data = fl_value_new_map();
+      fl_value_set_string_take(event_data, "lag", fl_value_new_int(lag));
+      fl_value_set_string_take(event_data, "handler",
+                               longest_handler_duration > 0
+                                   ? fl_value_new_string(longest_handler_name)
+                                   : fl_value_new_null());
+      fl_value_set_string_take(event_data, "handlerDuration",
+                               fl_value_new_int(longest_handler_duration));
+      _emit_event_data(self, "main-loop-stall", event_data);
+    }
+  }
+
+  longest_handler_duration = 0;
+  return G_SOURCE_CONTINUE;
+}
+
+static void stop_main_loop_monitor(WindowManagerPlugin* self) {
+  g_clear_handle_id(&self->main_loop_monitor_source_id, g_source_remove);
+}
+
+static FlMethodResponse* set_main_loop_monitor(WindowManagerPlugin* self,
+                                               FlValue* args) {
+  bool enabled = fl_value_get_bool(fl_value_lookup_string(args, "enabled"));
+  gint64 interval = fl_value_get_int(fl_value_lookup_string(args, "interval"));
+
+  stop_main_loop_monitor(self);
+  if (enabled && interval > 0) {
+    self->main_loop_interval = interval * 1000;
+    self->main_loop_stall_threshold =
+        fl_value_get_int(fl_value_lookup_string(args, "stallThreshold"));
+    self->_is_emitting_main_loop_stalls =
+        fl_value_get_bool(fl_value_lookup_string(args, "emitStalls"));
+    self->main_loop_last_tick = g_get_monotonic_time();
+    self->main_loop_monitor_source_id =
+        g_timeout_add_full(G_PRIORITY_LOW, interval, on_main_loop_heartbeat,
+                           self, nullptr);
+  }
+
   g_autoptr(FlValue) result = fl_value_new_bool(true);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
+static FlMethodResponse* get_main_loop_stats(WindowManagerPlugin* self) {
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(
+      result, "lagHistogram",
+      fl_value_new_int64_list(self->main_loop_lag_histogram,
+                              G_N_ELEMENTS(self->main_loop_lag_histogram)));
+  fl_value_set_string_take(result, "heartbeats",
+                           fl_value_new_int(self->main_loop_ticks));
+  fl_value_set_string_take(result, "stalls",
+                           fl_value_new_int(self->main_loop_stalls));
+  fl_value_set_string_take(result, "maxLag",
+                           fl_value_new_int(self->main_loop_max_lag));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+typedef struct {
+  gint64 count;
+  gint64 total_time;
+  gint64 max_time;
+} MethodStats;
+
+static FlMethodResponse* set_slow_handler_budget(WindowManagerPlugin* self,
+                                                 FlValue* args) {
+  gint64 budget = fl_value_get_int(fl_value_lookup_string(args, "budget"));
+  if (budget <= 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "setSlowHandlerBudget", "The budget must be positive.", nullptr));
+  }
+  slow_handler_budget = budget;
+
+  g_autoptr(FlValue) result = fl_value_new_bool(true);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* get_flight_recorder_path(WindowManagerPlugin* self) {
+  g_autoptr(FlValue) result = flight_recorder_path != nullptr
+                                  ? fl_value_new_string(flight_recorder_path)
+                                  : fl_value_new_null();
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* get_method_stats(WindowManagerPlugin* self) {
+  g_autoptr(FlValue) result = fl_value_new_map();
+  GHashTableIter iter;
+  gpointer key, value;
+  g_hash_table_iter_init(&iter, self->method_stats);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    MethodStats* stats = static_cast<MethodStats*>(value);
+    FlValue* entry = fl_value_new_map();
+    fl_value_set_string_take(entry, "count", fl_value_new_int(stats->count));
+    fl_value_set_string_take(entry, "totalTime",
+                             fl_value_new_int(stats->total_time));
+    fl_value_set_string_take(entry, "maxTime",
+                             fl_value_new_int(stats->max_time));
+    fl_value_set_string_take(result, static_cast<const gchar*>(key), entry);
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+typedef FlMethodResponse* (*MethodHandler)(WindowManagerPlugin* self,
+                                           FlValue* args);
+
+typedef struct {
+  const gchar* name;
+  MethodHandler handler;
+  // The arguments the handler reads, which are checked before automation
+  // requests are dispatched. They are space separated `key:type` pairs,
+  // where `key?` is optional and the type is one of b(ool), i(nt),
+  // d(ouble), s(tring), l(ist), m(ap), B (uint8 list) or D (float list).
+  const gchar* args;
+} MethodEntry;
+
+// Adapts a handler which takes no arguments to MethodHandler.
+template <FlMethodResponse* (*Handler)(WindowManagerPlugin*)>
+static FlMethodResponse* without_args(WindowManagerPlugin* self,
+                                      FlValue* args) {
+  return Handler(self);
+}
+
+// The methods handled by the plugin, sorted by name so that they can be
+// binary searched. Only the handlers of enabled features are compiled in.
+static constexpr MethodEntry kMethodHandlers[] = {
+    {"blur", without_args<blur>},
+    {"close", without_args<close>},
+    {"destroy", without_args<destroy>},
+#ifdef WINDOW_MANAGER_ENABLE_DOCKING
+    {"dock", without_args<dock>},
+#endif
+    {"ensureInitialized", without_args<ensure_initialized>},
+    {"focus", without_args<focus>},
+    {"getBounds", without_args<get_bounds>},
+    {"getFlightRecorderPath", without_args<get_flight_recorder_path>},
+    {"getMainLoopStats", without_args<get_main_loop_stats>},
+    {"getMethodStats", without_args<get_method_stats>},
+    {"getOpacity", without_args<get_opacity>},
+    {"getPlacement", without_args<get_placement>},
+    {"getTitle", without_args<get_title>},
+    {"getTitleBarHeight", get_title_bar_height},
+#ifdef WINDOW_MANAGER_ENABLE_GRABS
+    {"grabKeyboard", grab_keyboard, "accelerators?:l"},
+#endif
+    {"hide", hide, "transition?:m"},
+    {"isAlwaysOnBottom", without_args<is_always_on_bottom>},
+    {"isAlwaysOnTop", without_args<is_always_on_top>},
+    {"isClosable", without_args<is_closable>},
+#ifdef WINDOW_MANAGER_ENABLE_DOCKING
+    {"isDockable", without_args<is_dockable>},
+    {"isDocked", without_args<is_docked>},
+#endif
+    {"isFocused", without_args<is_focused>},
+    {"isFullScreen", without_args<is_full_screen>},
+    {"isMaximizable", without_args<is_maximizable>},
+    {"isMaximized", without_args<is_maximized>},
+    {"isMinimizable", without_args<is_minimizable>},
+    {"isMinimized", without_args<is_minimized>},
+    {"isPreventClose", without_args<is_prevent_close>},
+    {"isResizable", without_args<is_resizable>},
+    {"isSkipTaskbar", without_args<is_skip_taskbar>},
+    {"isVisible", without_args<is_visible>},
+#ifdef WINDOW_MANAGER_ENABLE_GRABS
+    {"lockPointer", without_args<lock_pointer>},
+#endif
+    {"maximize", without_args<maximize>},
+    {"minimize", without_args<minimize>},
+    {"popUpWindowMenu", without_args<pop_up_window_menu>},
+    {"restore", without_args<restore>},
+    {"setAlwaysOnBottom", set_always_on_bottom, "isAlwaysOnBottom:b"},
+    {"setAlwaysOnTop", set_always_on_top, "isAlwaysOnTop:b"},
+    {"setAsFrameless", set_as_frameless},
+    {"setAspectRatio", set_aspect_ratio, "aspectRatio:d"},
+#ifdef WINDOW_MANAGER_ENABLE_BACKGROUND_COLOR
+    {"setBackgroundColor", set_background_color,
+     "backgroundColorR:i backgroundColorG:i backgroundColorB:i "
+     "backgroundColorA:i"},
+#endif
+    {"setBounds", set_bounds, "x?:d y?:d width?:d height?:d"},
+#ifdef WINDOW_MANAGER_ENABLE_BRIGHTNESS
+    {"setBrightness", set_brightness, "brightness:s"},
+#endif
+    {"setClosable", set_closable, "isClosable:b"},
+    {"setDragSnapping", set_drag_snapping, "enabled:b distance?:d targets?:D"},
+    {"setFullScreen", set_full_screen,
+     "isFullScreen:b monitor?:i bypassCompositor?:b inhibitScreensaver?:b"},
+    {"setIcon", set_icon, "iconPath:s"},
+    {"setInputMask", set_input_mask, "mask?:B width?:i height?:i threshold?:i"},
+    {"setLifecycleReporting", set_lifecycle_reporting, "isEnabled:b"},
+    {"setMainLoopMonitor", set_main_loop_monitor,
+     "enabled:b interval:i stallThreshold:i emitStalls:b"},
+    {"setMaximizable", set_maximizable, "isMaximizable:b"},
+    {"setMaximumSize", set_maximum_size, "width:d height:d"},
+    {"setMinimizable", set_minimizable, "isMinimizable:b"},
+    {"setMinimumSize", set_minimum_size, "width:d height:d"},
+    {"setNativeTitleBar", set_native_title_bar,
+     "enabled:b height?:d decorationLayout?:s"},
+    {"setOpacity", set_opacity, "opacity:d"},
+    {"setPlacement", set_placement,
+     "x:d y:d width:d height:d state:s monitor?:i workspace?:i"},
+    {"setPreventClose", set_prevent_close, "isPreventClose:b"},
+    {"setResizable", set_resizable, "isResizable:b"},
+    {"setResizeIncrements", set_resize_increments,
+     "width:d height:d baseWidth:d baseHeight:d"},
+    {"setSkipTaskbar", set_skip_taskbar, "isSkipTaskbar:b"},
+    {"setSlowHandlerBudget", set_slow_handler_budget, "budget:i"},
+    {"setTitle", set_title, "title:s"},
+    {"setTitleBarStyle", set_title_bar_style, "titleBarStyle:s"},
+    {"show", show, "transition?:m"},
+    {"startDragging", without_args<start_dragging>},
+    {"startResizing", start_resizing, "resizeEdge:s"},
+#ifdef WINDOW_MANAGER_ENABLE_DOCKING
+    {"undock", without_args<undock>},
+#endif
+#ifdef WINDOW_MANAGER_ENABLE_GRABS
+    {"ungrabKeyboard", without_args<ungrab_keyboard>},
+    {"unlockPointer", without_args<unlock_pointer>},
+#endif
+    {"unmaximize", without_args<unmaximize>},
+    {"waitUntilReadyToShow", without_args<ensure_initialized>},
+};
+
+constexpr int compare_method_names(const gchar* a, const gchar* b) {
+  return (*a != *b || *a == '\0') ? *a - *b
+                                  : compare_method_names(a + 1, b + 1);
+}
+
+constexpr bool is_sorted_by_name(const MethodEntry* entries, size_t length) {
+  return length < 2 ||
+         (compare_method_names(entries[0].name, entries[1].name) < 0 &&
+          is_sorted_by_name(entries + 1, length - 1));
+}
+
+static_assert(is_sorted_by_name(kMethodHandlers,
+                                G_N_ELEMENTS(kMethodHandlers)),
+              "kMethodHandlers must be sorted by name");
+
+static const MethodEntry* find_method_entry(const gchar* method) {
+  size_t low = 0;
+  size_t high = G_N_ELEMENTS(kMethodHandlers);
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    int cmp = strcmp(method, kMethodHandlers[mid].name);
+    if (cmp == 0)
+      return &kMethodHandlers[mid];
+    if (cmp < 0)
+      high = mid;
+    else
+      low = mid + 1;
+  }
+  return nullptr;
+}
+
+// Calls the handler of the given method and records its latency in
+// method_stats.
+static FlMethodResponse* call_method(WindowManagerPlugin* self,
+                                     const gchar* method,
+                                     FlValue* args) {
+  const MethodEntry* entry = find_method_entry(method);
+  if (entry == nullptr)
+    return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+
+  gint64 start_time = g_get_monotonic_time();
+  FlMethodResponse* response;
+  {
+    FlightRecorderScope scope(self, kFlightRecordMethodCall, method);
+    response = entry->handler(self, args);
+    if (FL_IS_METHOD_ERROR_RESPONSE(response))
+      scope.set_failed();
+  }
+  gint64 elapsed = g_get_monotonic_time() - start_time;
+
+  MethodStats* stats = static_cast<MethodStats*>(
+      g_hash_table_lookup(self->method_stats, method));
+  if (stats == nullptr) {
+    stats = g_new0(MethodStats, 1);
+    g_hash_table_insert(self->method_stats, g_strdup(method), stats);
+  }
+  stats->count++;
+  stats->total_time += elapsed;
+  stats->max_time = MAX(stats->max_time, elapsed);
+
+  return response;
+}
+
 // Called when a method call is received from Flutter.
 static void window_manager_plugin_handle_method_call(
     WindowManagerPlugin* self,
@@ -811,135 +3302,329 @@ static void window_manager_plugin_handle_method_call(
   const gchar* method = fl_method_call_get_name(method_call);
   FlValue* args = fl_method_call_get_args(method_call);
 
-  if (g_strcmp0(method, "ensureInitialized") == 0) {
-    g_autoptr(FlValue) result = fl_value_new_bool(true);
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
-  } else if (g_strcmp0(method, "waitUntilReadyToShow") == 0) {
-    g_autoptr(FlValue) result = fl_value_new_bool(true);
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
-  } else if (g_strcmp0(method, "setAsFrameless") == 0) {
-    response = set_as_frameless(self, args);
-  } else if (g_strcmp0(method, "destroy") == 0) {
-    response = destroy(self);
-  } else if (g_strcmp0(method, "close") == 0) {
-    response = close(self);
-  } else if (g_strcmp0(method, "setPreventClose") == 0) {
-    response = set_prevent_close(self, args);
-  } else if (g_strcmp0(method, "isPreventClose") == 0) {
-    response = is_prevent_close(self);
-  } else if (g_strcmp0(method, "focus") == 0) {
-    response = focus(self);
-  } else if (g_strcmp0(method, "blur") == 0) {
-    response = blur(self);
-  } else if (g_strcmp0(method, "isFocused") == 0) {
-    response = is_focused(self);
-  } else if (g_strcmp0(method, "show") == 0) {
-    response = show(self);
-  } else if (g_strcmp0(method, "hide") == 0) {
-    response = hide(self);
-  } else if (g_strcmp0(method, "isVisible") == 0) {
-    response = is_visible(self);
-  } else if (g_strcmp0(method, "isMaximized") == 0) {
-    response = is_maximized(self);
-  } else if (g_strcmp0(method, "maximize") == 0) {
-    response = maximize(self);
-  } else if (g_strcmp0(method, "unmaximize") == 0) {
-    response = unmaximize(self);
-  } else if (g_strcmp0(method, "isMinimized") == 0) {
-    response = is_minimized(self);
-  } else if (g_strcmp0(method, "minimize") == 0) {
-    response = minimize(self);
-  } else if (g_strcmp0(method, "restore") == 0) {
-    response = restore(self);
-  } else if (g_strcmp0(method, "isDockable") == 0) {
-    response = is_dockable(self);
-  } else if (g_strcmp0(method, "isDocked") == 0) {
-    response = is_docked(self);
-  } else if (g_strcmp0(method, "dock") == 0) {
-    response = dock(self);
-  } else if (g_strcmp0(method, "undock") == 0) {
-    response = undock(self);
-  } else if (g_strcmp0(method, "isFullScreen") == 0) {
-    response = is_full_screen(self);
-  } else if (g_strcmp0(method, "setFullScreen") == 0) {
-    response = set_full_screen(self, args);
-  } else if (g_strcmp0(method, "setAspectRatio") == 0) {
-    response = set_aspect_ratio(self, args);
-  } else if (g_strcmp0(method, "setBackgroundColor") == 0) {
-    response = set_background_color(self, args);
-  } else if (g_strcmp0(method, "getBounds") == 0) {
-    response = get_bounds(self);
-  } else if (g_strcmp0(method, "setBounds") == 0) {
-    response = set_bounds(self, args);
-  } else if (g_strcmp0(method, "setMinimumSize") == 0) {
-    response = set_minimum_size(self, args);
-  } else if (g_strcmp0(method, "setMaximumSize") == 0) {
-    response = set_maximum_size(self, args);
-  } else if (g_strcmp0(method, "isResizable") == 0) {
-    response = is_resizable(self);
-  } else if (g_strcmp0(method, "setResizable") == 0) {
-    response = set_resizable(self, args);
-  } else if (g_strcmp0(method, "isMinimizable") == 0) {
-    response = is_minimizable(self);
-  } else if (g_strcmp0(method, "setMinimizable") == 0) {
-    response = set_minimizable(self, args);
-  } else if (g_strcmp0(method, "isMaximizable") == 0) {
-    response = is_maximizable(self);
-  } else if (g_strcmp0(method, "setMaximizable") == 0) {
-    response = set_maximizable(self, args);
-  } else if (g_strcmp0(method, "isClosable") == 0) {
-    response = is_closable(self);
-  } else if (g_strcmp0(method, "setClosable") == 0) {
-    response = set_closable(self, args);
-  } else if (g_strcmp0(method, "isAlwaysOnTop") == 0) {
-    response = is_always_on_top(self);
-  } else if (g_strcmp0(method, "setAlwaysOnTop") == 0) {
-    response = set_always_on_top(self, args);
-  } else if (g_strcmp0(method, "isAlwaysOnBottom") == 0) {
-    response = is_always_on_bottom(self);
-  } else if (g_strcmp0(method, "setAlwaysOnBottom") == 0) {
-    response = set_always_on_bottom(self, args);
-  } else if (g_strcmp0(method, "getTitle") == 0) {
-    response = get_title(self);
-  } else if (g_strcmp0(method, "setTitle") == 0) {
-    response = set_title(self, args);
-  } else if (g_strcmp0(method, "setTitleBarStyle") == 0) {
-    response = set_title_bar_style(self, args);
-  } else if (g_strcmp0(method, "getTitleBarHeight") == 0) {
-    response = get_title_bar_height(self, args);
-  } else if (g_strcmp0(method, "isSkipTaskbar") == 0) {
-    response = is_skip_taskbar(self);
-  } else if (g_strcmp0(method, "setSkipTaskbar") == 0) {
-    response = set_skip_taskbar(self, args);
-  } else if (g_strcmp0(method, "setIcon") == 0) {
-    response = set_icon(self, args);
-  } else if (g_strcmp0(method, "getOpacity") == 0) {
-    response = get_opacity(self);
-  } else if (g_strcmp0(method, "setOpacity") == 0) {
-    response = set_opacity(self, args);
-  } else if (g_strcmp0(method, "popUpWindowMenu") == 0) {
-    response = pop_up_window_menu(self);
-  } else if (g_strcmp0(method, "startDragging") == 0) {
-    response = start_dragging(self);
-  } else if (g_strcmp0(method, "startResizing") == 0) {
-    response = start_resizing(self, args);
-  } else if (g_strcmp0(method, "grabKeyboard") == 0) {
-    response = grab_keyboard(self);
-  } else if (g_strcmp0(method, "ungrabKeyboard") == 0) {
-    response = ungrab_keyboard(self);
-  } else if (g_strcmp0(method, "setBrightness") == 0) {
-    response = set_brightness(self, args);
+  response = call_method(self, method, args);
+
+  fl_method_call_respond(method_call, response, nullptr);
+}
+
+// The automation socket is enabled by setting WINDOW_MANAGER_AUTOMATION_SOCKET
+// to a path. Each request is a line holding a method name optionally
+// followed by its arguments as JSON, e.g. `setBounds {"x": 0.0, "y": 0.0}`,
+// and is answered with a JSON line holding either `result` or `error` and
+// `message`. Arguments are checked against the types the handler reads,
+// using MethodEntry::args, so doubles need a decimal point.
+typedef struct {
+  WindowManagerPlugin* plugin;
+  GSocketConnection* connection;
+  GDataInputStream* input;
+  GCancellable* cancellable;
+  // The reply being written, newline included.
+  gchar* reply;
+} AutomationClient;
+
+static void automation_client_free(AutomationClient* client) {
+  g_io_stream_close(G_IO_STREAM(client->connection), nullptr, nullptr);
+  g_object_unref(client->input);
+  g_object_unref(client->connection);
+  g_object_unref(client->cancellable);
+  g_free(client->reply);
+  g_free(client);
+}
+
+static gchar* handle_automation_request(WindowManagerPlugin* self,
+                                        gchar* line) {
+  g_autoptr(FlJsonMessageCodec) codec = fl_json_message_codec_new();
+  g_autoptr(FlValue) reply = fl_value_new_map();
+
+  gchar* args_text = strchr(line, ' ');
+  if (args_text != nullptr)
+    *args_text++ = '\0';
+
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(FlValue) args = nullptr;
+  if (args_text != nullptr && *g_strstrip(args_text) != '\0')
+    args = fl_json_message_codec_decode(codec, args_text, &error);
+  else
+    args = fl_value_new_null();
+
+  // Requests without arguments reach the handlers as an empty map, like
+  // the calls which drop their null arguments.
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_NULL) {
+    fl_value_unref(args);
+    args = fl_value_new_map();
+  }
+
+  const MethodEntry* entry = find_method_entry(line);
+  g_autofree gchar* args_message = nullptr;
+  if (args == nullptr) {
+    args_message = g_strdup(error->message);
+    g_clear_error(&error);
+  } else if (entry != nullptr && entry->args != nullptr) {
+    has_args(entry->args, args, &args_message);
+  } else if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    args_message = g_strdup("Arguments must be an object");
+  }
+
+  if (args_message != nullptr) {
+    fl_value_set_string_take(reply, "error",
+                             fl_value_new_string("invalidArguments"));
+    fl_value_set_string_take(reply, "message",
+                             fl_value_new_string(args_message));
   } else {
-    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+    g_autoptr(FlMethodResponse) response = call_method(self, line, args);
+    if (FL_IS_METHOD_SUCCESS_RESPONSE(response)) {
+      FlValue* result = fl_method_success_response_get_result(
+          FL_METHOD_SUCCESS_RESPONSE(response));
+      fl_value_set_string(reply, "result", result);
+    } else if (FL_IS_METHOD_ERROR_RESPONSE(response)) {
+      FlMethodErrorResponse* error_response =
+          FL_METHOD_ERROR_RESPONSE(response);
+      const gchar* message =
+          fl_method_error_response_get_message(error_response);
+      fl_value_set_string_take(
+          reply, "error",
+          fl_value_new_string(
+              fl_method_error_response_get_code(error_response)));
+      fl_value_set_string_take(reply, "message",
+                               message != nullptr ? fl_value_new_string(message)
+                                                  : fl_value_new_null());
+    } else {
+      fl_value_set_string_take(reply, "error",
+                               fl_value_new_string("notImplemented"));
+      fl_value_set_string_take(reply, "message", fl_value_new_null());
+    }
   }
 
-  fl_method_call_respond(method_call, response, nullptr);
+  gchar* text = fl_json_message_codec_encode(codec, reply, &error);
+  if (text == nullptr) {
+    g_warning("Failed to encode automation reply: %s", error->message);
+    text = g_strdup("{\"error\":\"encodeFailed\",\"message\":null}");
+  }
+  return text;
+}
+
+static void on_automation_line_read(GObject* source,
+                                    GAsyncResult* result,
+                                    gpointer user_data);
+
+static void on_automation_reply_written(GObject* source,
+                                        GAsyncResult* result,
+                                        gpointer user_data) {
+  AutomationClient* client = static_cast<AutomationClient*>(user_data);
+  if (!g_output_stream_write_all_finish(G_OUTPUT_STREAM(source), result,
+                                        nullptr, nullptr) ||
+      g_cancellable_is_cancelled(client->cancellable)) {
+    automation_client_free(client);
+    return;
+  }
+
+  g_clear_pointer(&client->reply, g_free);
+  g_data_input_stream_read_line_async(client->input, G_PRIORITY_DEFAULT,
+                                      client->cancellable,
+                                      on_automation_line_read, client);
+}
+
+static void on_automation_line_read(GObject* source,
+                                    GAsyncResult* result,
+                                    gpointer user_data) {
+  AutomationClient* client = static_cast<AutomationClient*>(user_data);
+
+  g_autoptr(GError) error = nullptr;
+  g_autofree gchar* line = g_data_input_stream_read_line_finish_utf8(
+      client->input, result, nullptr, &error);
+  // The plugin is gone once the cancellable is cancelled.
+  if (line == nullptr || g_cancellable_is_cancelled(client->cancellable)) {
+    automation_client_free(client);
+    return;
+  }
+
+  // Written asynchronously, so that a client which does not read its
+  // replies cannot block the main loop. The next request is read once the
+  // reply is written.
+  g_autofree gchar* reply = handle_automation_request(client->plugin, line);
+  client->reply = g_strconcat(reply, "\n", nullptr);
+  g_output_stream_write_all_async(
+      g_io_stream_get_output_stream(G_IO_STREAM(client->connection)),
+      client->reply, strlen(client->reply), G_PRIORITY_DEFAULT,
+      client->cancellable, on_automation_reply_written, client);
+}
+
+static gboolean on_automation_incoming(GSocketService* service,
+                                       GSocketConnection* connection,
+                                       GObject* source_object,
+                                       gpointer user_data) {
+  WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(user_data);
+
+  AutomationClient* client = g_new0(AutomationClient, 1);
+  client->plugin = self;
+  client->connection = G_SOCKET_CONNECTION(g_object_ref(connection));
+  client->input = g_data_input_stream_new(
+      g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+  client->cancellable =
+      G_CANCELLABLE(g_object_ref(self->automation_cancellable));
+  g_data_input_stream_set_newline_type(client->input,
+                                       G_DATA_STREAM_NEWLINE_TYPE_ANY);
+  g_data_input_stream_read_line_async(client->input, G_PRIORITY_DEFAULT,
+                                      client->cancellable,
+                                      on_automation_line_read, client);
+  return true;
+}
+
+static void start_automation_server(WindowManagerPlugin* self) {
+  const gchar* path = g_getenv("WINDOW_MANAGER_AUTOMATION_SOCKET");
+  if (path == nullptr || *path == '\0')
+    return;
+
+  struct sockaddr_un native_address = {};
+  if (strlen(path) >= sizeof(native_address.sun_path)) {
+    g_warning("Automation socket path is too long: %s", path);
+    return;
+  }
+  native_address.sun_family = AF_UNIX;
+  strcpy(native_address.sun_path, path);
+  g_autoptr(GSocketAddress) address = g_socket_address_new_from_native(
+      &native_address, sizeof(native_address));
+
+  // A socket left behind by a previous run would make the bind fail.
+  g_unlink(path);
+
+  g_autoptr(GError) error = nullptr;
+  GSocketService* service = g_socket_service_new();
+  if (!g_socket_listener_add_address(
+          G_SOCKET_LISTENER(service), address, G_SOCKET_TYPE_STREAM,
+          G_SOCKET_PROTOCOL_DEFAULT, nullptr, nullptr, &error)) {
+    g_warning("Failed to listen on automation socket %s: %s", path,
+              error->message);
+    g_object_unref(service);
+    return;
+  }
+
+  self->automation_service = service;
+  self->automation_cancellable = g_cancellable_new();
+  self->automation_socket_path = g_strdup(path);
+  g_signal_connect(service, "incoming", G_CALLBACK(on_automation_incoming),
+                   self);
+  g_socket_service_start(service);
+}
+
+static void stop_automation_server(WindowManagerPlugin* self) {
+  if (self->automation_service == nullptr)
+    return;
+
+  g_cancellable_cancel(self->automation_cancellable);
+  g_socket_service_stop(self->automation_service);
+  g_socket_listener_close(G_SOCKET_LISTENER(self->automation_service));
+  g_signal_handlers_disconnect_by_data(self->automation_service, self);
+  g_clear_object(&self->automation_service);
+  g_clear_object(&self->automation_cancellable);
+  g_unlink(self->automation_socket_path);
+  g_clear_pointer(&self->automation_socket_path, g_free);
+}
+
+// Releases everything the plugin holds on the window, which outlives the
+// engine when the app creates and destroys engines in the same window.
+static void release_window(WindowManagerPlugin* self) {
+#ifdef WINDOW_MANAGER_ENABLE_GRABS
+  // The raw motion filter and the XI2 selection are not tied to the window,
+  // so they must go even when the window is already gone.
+  if (self->_is_raw_motion) {
+    select_raw_motion(self, false);
+    self->_is_raw_motion = false;
+  }
+#endif
+
+  GtkWindow* window = self->window;
+  if (window == nullptr) {
+    // The handlers, the tick callback and the grabs went away together with
+    // the window.
+    self->accelerator_handler_id = 0;
+    self->pointer_motion_handler_id = 0;
+    self->pointer_motion_tick_id = 0;
+    self->snap_motion_handler_id = 0;
+    self->snap_release_handler_id = 0;
+    self->_is_pointer_locked = false;
+    self->_is_snap_dragging = false;
+    self->grab_pointer = nullptr;
+    return;
+  }
+
+#ifdef WINDOW_MANAGER_ENABLE_GRABS
+  if (self->_is_pointer_locked) {
+    // Do not grab the keyboard again after unlocking.
+    self->grab_pointer = nullptr;
+    g_autoptr(FlMethodResponse) response = unlock_pointer(self);
+  }
+  g_autoptr(FlMethodResponse) response = ungrab_keyboard(self);
+#endif
+  if (self->_is_snap_dragging) {
+    self->_is_snap_dragging = false;
+    update_seat_grab(self, self->grab_pointer != nullptr,
+                     self->_is_pointer_locked);
+  }
+
+  GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(window));
+  if (self->input_mask != nullptr && gdk_window != nullptr)
+    gdk_window_input_shape_combine_region(gdk_window, nullptr, 0, 0);
+  if (self->css_provider != nullptr) {
+    gtk_style_context_remove_provider(
+        gtk_widget_get_style_context(GTK_WIDGET(window)),
+        GTK_STYLE_PROVIDER(self->css_provider));
+  }
+  set_inhibit_screensaver(self, false);
+
+  g_signal_handlers_disconnect_by_data(window, self);
+  self->accelerator_handler_id = 0;
+  self->pointer_motion_handler_id = 0;
+  self->snap_motion_handler_id = 0;
+  self->snap_release_handler_id = 0;
+
+  g_object_remove_weak_pointer(G_OBJECT(window),
+                               reinterpret_cast<gpointer*>(&self->window));
+  self->window = nullptr;
 }
 
 static void window_manager_plugin_dispose(GObject* object) {
   WindowManagerPlugin* self = WINDOW_MANAGER_PLUGIN(object);
+#ifdef WINDOW_MANAGER_ENABLE_BRIGHTNESS
+  GtkSettings* settings = gtk_settings_get_default();
+  g_clear_signal_handler(&self->theme_name_handler_id, settings);
+  if (self->session_bus_cancellable != nullptr) {
+    g_cancellable_cancel(self->session_bus_cancellable);
+    g_clear_object(&self->session_bus_cancellable);
+  }
+  g_clear_handle_id(&self->brightness_changed_source_id, g_source_remove);
+  if (self->color_scheme_subscription_id != 0) {
+    g_dbus_connection_signal_unsubscribe(self->session_bus,
+                                         self->color_scheme_subscription_id);
+    self->color_scheme_subscription_id = 0;
+  }
+  g_clear_object(&self->session_bus);
+#endif
+  stop_automation_server(self);
+  remove_transition_tick(self);
+  stop_lifecycle_reporting(self, false);
+  release_window(self);
+  if (self->button_press_hook_id != 0) {
+    g_signal_remove_emission_hook(
+        g_signal_lookup("button-press-event", GTK_TYPE_WIDGET),
+        self->button_press_hook_id);
+    self->button_press_hook_id = 0;
+  }
+  track_header_bar(self, nullptr);
+  g_clear_handle_id(&self->frame_metrics_changed_source_id, g_source_remove);
+#ifdef WINDOW_MANAGER_ENABLE_GRABS
+  clear_accelerators(self);
+#endif
+  clear_input_mask(self);
+  stop_main_loop_monitor(self);
+  g_clear_pointer(&self->transition_easing, g_free);
+  close_flight_recorder();
+  g_clear_pointer(&self->method_stats, g_hash_table_unref);
+  g_clear_pointer(&self->snap_targets, g_array_unref);
   g_clear_object(&self->css_provider);
-  g_free(self->title_bar_style_);
+  g_clear_pointer(&self->title_bar_style_, g_free);
+  g_clear_object(&self->channel);
+  g_clear_object(&self->registrar);
   G_OBJECT_CLASS(window_manager_plugin_parent_class)->dispose(object);
 }
 
@@ -956,53 +3641,55 @@ static void method_call_cb(FlMethodChannel* channel,
   window_manager_plugin_handle_method_call(plugin, method_call);
 }
 
-void _emit_event(WindowManagerPlugin* plugin, const char* event_name) {
-  g_autoptr(FlValue) result_data = fl_value_new_map();
-  fl_value_set_string_take(result_data, "eventName",
-                           fl_value_new_string(event_name));
-  fl_method_channel_invoke_method(plugin->channel, "onEvent", result_data,
-                                  nullptr, nullptr, nullptr);
-}
-
 gboolean on_window_close(GtkWidget* widget, GdkEvent* event, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  FlightRecorderScope scope(plugin, kFlightRecordSignal, "delete-event");
   _emit_event(plugin, "close");
   return plugin->_is_prevent_close;
 }
 
 gboolean on_window_focus(GtkWidget* widget, GdkEvent* event, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  FlightRecorderScope scope(plugin, kFlightRecordSignal, "focus-in-event");
   _emit_event(plugin, "focus");
   return false;
 }
 
 gboolean on_window_blur(GtkWidget* widget, GdkEvent* event, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  FlightRecorderScope scope(plugin, kFlightRecordSignal, "focus-out-event");
   _emit_event(plugin, "blur");
   return false;
 }
 
 gboolean on_window_show(GtkWidget* widget, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  FlightRecorderScope scope(plugin, kFlightRecordSignal, "show");
   _emit_event(plugin, "show");
   return false;
 }
 
 gboolean on_window_hide(GtkWidget* widget, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  FlightRecorderScope scope(plugin, kFlightRecordSignal, "hide");
   _emit_event(plugin, "hide");
   return false;
 }
 
 gboolean on_window_resize(GtkWidget* widget, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  FlightRecorderScope scope(plugin, kFlightRecordSignal, "check-resize");
   _emit_event(plugin, "resize");
   return false;
 }
 
 gboolean on_window_move(GtkWidget* widget, GdkEvent* event, gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
-  _emit_event(plugin, "move");
+  FlightRecorderScope scope(plugin, kFlightRecordSignal, "configure-event");
+  update_normal_bounds(plugin);
+  // A snap drag reports its final position once, when it ends.
+  if (!plugin->_is_snap_dragging)
+    _emit_event(plugin, "move");
   return false;
 }
 
@@ -1010,6 +3697,13 @@ gboolean on_window_state_change(GtkWidget* widget,
                                 GdkEventWindowState* event,
                                 gpointer data) {
   WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  FlightRecorderScope scope(plugin, kFlightRecordWindowState,
+                            "window-state-event");
+  if ((event->new_window_state & kNonNormalWindowStates) &&
+      !((event->new_window_state ^ event->changed_mask) &
+        kNonNormalWindowStates)) {
+    on_normal_state_left(plugin);
+  }
   if (event->changed_mask & GDK_WINDOW_STATE_MAXIMIZED) {
     if (event->new_window_state & GDK_WINDOW_STATE_MAXIMIZED) {
       _emit_event(plugin, "maximize");
@@ -1025,15 +3719,153 @@ gboolean on_window_state_change(GtkWidget* widget,
     }
   }
   if (event->changed_mask & GDK_WINDOW_STATE_FULLSCREEN) {
-    if (event->new_window_state & GDK_WINDOW_STATE_FULLSCREEN) {
-      _emit_event(plugin, "enter-full-screen");
+    bool is_full_screen = event->new_window_state & GDK_WINDOW_STATE_FULLSCREEN;
+
+    // Report how long the transition took since setFullScreen was called, so
+    // that the app can tell whether the compositor unredirected the window.
+    FlValue* event_data = fl_value_new_map();
+    fl_value_set_string_take(event_data, "isFullScreen",
+                             fl_value_new_bool(is_full_screen));
+    fl_value_set_string_take(
+        event_data, "bypassCompositor",
+        fl_value_new_bool(plugin->_is_bypass_compositor));
+    if (plugin->full_screen_request_time != 0) {
+      fl_value_set_string_take(
+          event_data, "duration",
+          fl_value_new_int(g_get_monotonic_time() -
+                           plugin->full_screen_request_time));
+      plugin->full_screen_request_time = 0;
+    }
+
+    if (is_full_screen) {
+      _emit_event_data(plugin, "enter-full-screen", event_data);
     } else {
-      _emit_event(plugin, "leave-full-screen");
+      _emit_event_data(plugin, "leave-full-screen", event_data);
+      release_full_screen_hints(plugin);
     }
   }
   return false;
 }
 
+#ifdef WINDOW_MANAGER_ENABLE_BRIGHTNESS
+static gboolean emit_brightness_changed(gpointer data) {
+  WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  plugin->brightness_changed_source_id = 0;
+
+  bool is_dark = is_system_dark(plugin);
+  if (is_dark != plugin->_is_dark) {
+    plugin->_is_dark = is_dark;
+    FlValue* event_data = fl_value_new_map();
+    fl_value_set_string_take(event_data, "brightness",
+                             fl_value_new_string(is_dark ? "dark" : "light"));
+    _emit_event_data(plugin, "brightness-changed", event_data);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// Coalesces bursts of setting changes (a theme switch usually changes
+// several settings at once) into a single brightness-changed event.
+static void queue_brightness_changed(WindowManagerPlugin* plugin) {
+  if (plugin->brightness_changed_source_id == 0) {
+    plugin->brightness_changed_source_id =
+        g_timeout_add(100, emit_brightness_changed, plugin);
+  }
+}
+
+void on_gtk_settings_notify(GObject* object,
+                            GParamSpec* pspec,
+                            gpointer data) {
+  WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  if (!plugin->_is_setting_brightness && plugin->portal_color_scheme <= 0) {
+    queue_brightness_changed(plugin);
+  }
+}
+
+void on_portal_setting_changed(GDBusConnection* connection,
+                               const gchar* sender_name,
+                               const gchar* object_path,
+                               const gchar* interface_name,
+                               const gchar* signal_name,
+                               GVariant* parameters,
+                               gpointer data) {
+  WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  const gchar* name_space = nullptr;
+  const gchar* key = nullptr;
+  g_autoptr(GVariant) value = nullptr;
+  g_variant_get(parameters, "(&s&sv)", &name_space, &key, &value);
+  if (g_strcmp0(name_space, "org.freedesktop.appearance") == 0 &&
+      g_strcmp0(key, "color-scheme") == 0 &&
+      g_variant_is_of_type(value, G_VARIANT_TYPE_UINT32)) {
+    plugin->portal_color_scheme = g_variant_get_uint32(value);
+    queue_brightness_changed(plugin);
+  }
+}
+
+void on_portal_color_scheme_read(GObject* source,
+                                 GAsyncResult* res,
+                                 gpointer data) {
+  WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  g_autoptr(GVariant) result =
+      g_dbus_connection_call_finish(G_DBUS_CONNECTION(source), res, nullptr);
+  if (result == nullptr) {
+    g_object_unref(plugin);
+    return;
+  }
+
+  // Settings.Read wraps the value in an extra variant.
+  g_autoptr(GVariant) outer = nullptr;
+  g_variant_get(result, "(v)", &outer);
+  g_autoptr(GVariant) value =
+      g_variant_is_of_type(outer, G_VARIANT_TYPE_VARIANT)
+          ? g_variant_get_variant(outer)
+          : g_variant_ref(outer);
+  if (g_variant_is_of_type(value, G_VARIANT_TYPE_UINT32)) {
+    plugin->portal_color_scheme = g_variant_get_uint32(value);
+    plugin->_is_dark = is_system_dark(plugin);
+  }
+  g_object_unref(plugin);
+}
+
+void on_session_bus_get(GObject* source, GAsyncResult* res, gpointer data) {
+  g_autoptr(GDBusConnection) session_bus = g_bus_get_finish(res, nullptr);
+  // Also null when the plugin was disposed, which cancels the call.
+  if (session_bus == nullptr)
+    return;
+
+  WindowManagerPlugin* plugin = WINDOW_MANAGER_PLUGIN(data);
+  g_clear_object(&plugin->session_bus_cancellable);
+  plugin->session_bus = G_DBUS_CONNECTION(g_steal_pointer(&session_bus));
+
+  plugin->color_scheme_subscription_id = g_dbus_connection_signal_subscribe(
+      plugin->session_bus, "org.freedesktop.portal.Desktop",
+      "org.freedesktop.portal.Settings", "SettingChanged",
+      "/org/freedesktop/portal/desktop", "org.freedesktop.appearance",
+      G_DBUS_SIGNAL_FLAGS_NONE, on_portal_setting_changed, plugin, nullptr);
+  g_dbus_connection_call(
+      plugin->session_bus, "org.freedesktop.portal.Desktop",
+      "/org/freedesktop/portal/desktop", "org.freedesktop.portal.Settings",
+      "Read",
+      g_variant_new("(ss)", "org.freedesktop.appearance", "color-scheme"),
+      G_VARIANT_TYPE("(v)"), G_DBUS_CALL_FLAGS_NONE, -1, nullptr,
+      on_portal_color_scheme_read, g_object_ref(plugin));
+}
+
+// Watches the desktop color scheme through the settings portal and the GTK
+// theme name, so that apps are notified instead of having to poll. The
+// session bus is connected asynchronously, so that registering the plugin
+// does not wait for D-Bus.
+static void watch_system_brightness(WindowManagerPlugin* plugin) {
+  plugin->theme_name_handler_id =
+      g_signal_connect(gtk_settings_get_default(), "notify::gtk-theme-name",
+                       G_CALLBACK(on_gtk_settings_notify), plugin);
+  plugin->_is_dark = is_system_dark(plugin);
+
+  plugin->session_bus_cancellable = g_cancellable_new();
+  g_bus_get(G_BUS_TYPE_SESSION, plugin->session_bus_cancellable,
+            on_session_bus_get, plugin);
+}
+#endif
+
 void emit_button_release(WindowManagerPlugin* self) {
   auto newEvent = (GdkEventButton*)gdk_event_new(GDK_BUTTON_RELEASE);
   newEvent->x = self->_event_button.x;
@@ -1087,12 +3919,22 @@ void window_manager_plugin_register_with_registrar(
       g_object_new(window_manager_plugin_get_type(), nullptr));
 
   plugin->registrar = FL_PLUGIN_REGISTRAR(g_object_ref(registrar));
+  plugin->window = GTK_WINDOW(gtk_widget_get_toplevel(
+      GTK_WIDGET(fl_plugin_registrar_get_view(registrar))));
+  g_object_add_weak_pointer(G_OBJECT(plugin->window),
+                            reinterpret_cast<gpointer*>(&plugin->window));
 
   plugin->window_geometry.min_width = -1;
   plugin->window_geometry.min_height = -1;
   plugin->window_geometry.max_width = G_MAXINT;
   plugin->window_geometry.max_height = G_MAXINT;
   plugin->window_hints = static_cast<GdkWindowHints>(0);
+  plugin->portal_color_scheme = -1;
+  plugin->snap_distance = 12;
+  plugin->snap_targets = g_array_new(false, false, sizeof(GdkRectangle));
+  plugin->method_stats =
+      g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  open_flight_recorder();
 
   // Disconnect all delete-event handlers first in flutter 3.10.1, which causes delete_event not working.
   // Issues from flutter/engine: https://github.com/flutter/engine/pull/40033 
@@ -1119,9 +3961,22 @@ void window_manager_plugin_register_with_registrar(
                    G_CALLBACK(on_window_state_change), plugin);
   g_signal_connect(get_window(plugin), "event-after",
                    G_CALLBACK(on_event_after), plugin);
+  gtk_widget_add_events(GTK_WIDGET(get_window(plugin)),
+                        GDK_PROPERTY_CHANGE_MASK);
+  g_signal_connect(get_window(plugin), "property-notify-event",
+                   G_CALLBACK(on_window_property_notify), plugin);
+  g_signal_connect(get_window(plugin), "realize",
+                   G_CALLBACK(on_window_realize), plugin);
+  if (gtk_widget_get_realized(GTK_WIDGET(get_window(plugin))))
+    update_frame_extents(plugin);
+  update_normal_bounds(plugin);
+  get_cached_header_bar(plugin);
   find_event_box(plugin, GTK_WIDGET(fl_plugin_registrar_get_view(registrar)));
+#ifdef WINDOW_MANAGER_ENABLE_BRIGHTNESS
+  watch_system_brightness(plugin);
+#endif
 
-  g_signal_add_emission_hook(
+  plugin->button_press_hook_id = g_signal_add_emission_hook(
       g_signal_lookup("button-press-event", GTK_TYPE_WIDGET), 0, on_mouse_press,
       plugin, NULL);
 
@@ -1132,5 +3987,7 @@ void window_manager_plugin_register_with_registrar(
   fl_method_channel_set_method_call_handler(
       plugin->channel, method_call_cb, g_object_ref(plugin), g_object_unref);
 
+  start_automation_server(plugin);
+
   g_object_unref(plugin);
 }
@@ -1,10 +1,24 @@
 import 'package:flutter/services.dart';
 import 'package:flutter_test/flutter_test.dart';
-// import 'package:window_manager/window_manager.dart';
+import 'package:window_manager/window_manager.dart';
 
-void main() {
-  const MethodChannel channel = MethodChannel('window_manager');
+const MethodChannel channel = MethodChannel('window_manager');
+
+Future<void> sendEvent(String eventName, {bool withEventId = true}) async {
+  await TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+      .handlePlatformMessage(
+    channel.name,
+    channel.codec.encodeMethodCall(
+      MethodCall('onEvent', {
+        'eventName': eventName,
+        if (withEventId) 'eventId': kWindowEvents.indexOf(eventName),
+      }),
+    ),
+    (_) {},
+  );
+}
 
+void main() {
   TestWidgetsFlutterBinding.ensureInitialized();
 
   setUp(() {
@@ -18,10 +32,101 @@ void main() {
   });
 
   tearDown(() {
+    for (final listener in windowManager.listeners) {
+      windowManager.removeListener(listener);
+    }
     TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
         .setMockMethodCallHandler(
       channel,
       null,
     );
   });
+
+  test('routes events to the listeners subscribed to them', () async {
+    final _RecordingListener allEvents = _RecordingListener();
+    final _RecordingListener moveOnly = _RecordingListener();
+    final _RecordingListener focusAndBlur = _RecordingListener();
+    windowManager.addListener(allEvents);
+    windowManager.addListener(moveOnly, events: {kWindowEventMove});
+    windowManager.addListener(
+      focusAndBlur,
+      events: {kWindowEventFocus, kWindowEventBlur},
+    );
+
+    await sendEvent(kWindowEventMove);
+    await sendEvent(kWindowEventFocus);
+    // Platforms which only send the name are routed the same way.
+    await sendEvent(kWindowEventBlur, withEventId: false);
+    await sendEvent(kWindowEventResize);
+
+    expect(allEvents.events, [
+      kWindowEventMove,
+      kWindowEventFocus,
+      kWindowEventBlur,
+      kWindowEventResize,
+    ]);
+    expect(allEvents.moves, 1);
+    expect(allEvents.focuses, 1);
+    expect(moveOnly.events, [kWindowEventMove]);
+    expect(moveOnly.moves, 1);
+    expect(moveOnly.focuses, 0);
+    expect(focusAndBlur.events, [kWindowEventFocus, kWindowEventBlur]);
+    expect(focusAndBlur.moves, 0);
+    expect(focusAndBlur.focuses, 1);
+
+    // Adding a listener again replaces its events.
+    windowManager.addListener(moveOnly, events: {kWindowEventFocus});
+    await sendEvent(kWindowEventMove);
+    await sendEvent(kWindowEventFocus);
+    expect(moveOnly.moves, 1);
+    expect(moveOnly.focuses, 1);
+  });
+
+  test('skips listeners removed during dispatch', () async {
+    final _RecordingListener first = _RecordingListener();
+    final _RecordingListener removed = _RecordingListener();
+    final _RecordingListener last = _RecordingListener();
+    final _RecordingListener removedMoveOnly = _RecordingListener();
+    first.onMove = () {
+      windowManager.removeListener(removed);
+      windowManager.removeListener(removedMoveOnly);
+      windowManager.removeListener(first);
+    };
+    windowManager.addListener(first);
+    windowManager.addListener(removed);
+    windowManager.addListener(last);
+    windowManager.addListener(removedMoveOnly, events: {kWindowEventMove});
+
+    await sendEvent(kWindowEventMove);
+    expect(first.moves, 1);
+    expect(removed.moves, 0);
+    expect(last.moves, 1);
+    expect(removedMoveOnly.moves, 0);
+    expect(windowManager.listeners, [last]);
+
+    await sendEvent(kWindowEventMove);
+    expect(first.moves, 1);
+    expect(removed.moves, 0);
+    expect(last.moves, 2);
+    expect(removedMoveOnly.moves, 0);
+  });
+}
+
+class _RecordingListener with WindowListener {
+  final List<String> events = [];
+  int moves = 0;
+  int focuses = 0;
+  void Function()? onMove;
+
+  @override
+  void onWindowEvent(String eventName) => events.add(eventName);
+
+  @override
+  void onWindowMove() {
+    moves++;
+    onMove?.call();
+  }
+
+  @override
+  void onWindowFocus() => focuses++;
 }
@@ -0,0 +1,36 @@
+#!/bin/sh
+# Builds the Linux example with every optional feature enabled and with all
+# of them disabled, and reports for each:
+# - the stripped size of the plugin library
+# - the plugin registration cost, from the example's registration benchmark
+#
+# Needs the Flutter SDK and a desktop session. The dispatch cost of each
+# method is reported at run time by getMethodStats.
+set -e
+
+cd "$(dirname "$0")/../example"
+# Generates the files the CMake project needs and the release assets.
+flutter build linux --release > /dev/null
+
+case "$(uname -m)" in
+  aarch64) platform=linux-arm64 ;;
+  *) platform=linux-x64 ;;
+esac
+
+for config in full minimal; do
+  if [ "$config" = full ]; then value=ON; else value=OFF; fi
+  build="build/measure_features/$config"
+  cmake -S linux -B "$build" -DCMAKE_BUILD_TYPE=Release \
+    -DFLUTTER_TARGET_PLATFORM="$platform" \
+    -DWINDOW_MANAGER_ENABLE_GRABS="$value" \
+    -DWINDOW_MANAGER_ENABLE_BRIGHTNESS="$value" \
+    -DWINDOW_MANAGER_ENABLE_DOCKING="$value" \
+    -DWINDOW_MANAGER_ENABLE_BACKGROUND_COLOR="$value" > /dev/null
+  cmake --build "$build" --target install > /dev/null
+
+  strip -o "$build/libwindow_manager_plugin.so" \
+    "$build/bundle/lib/libwindow_manager_plugin.so"
+  echo "$config: $(wc -c < "$build/libwindow_manager_plugin.so") bytes"
+  WINDOW_MANAGER_REGISTRATION_BENCHMARK=100 \
+    "$build/bundle/window_manager_example" | tail -n 1
+done
@@ -0,0 +1,123 @@
+#include "window_sizing.h"
+
+#include <cstdio>
+
+namespace {
+
+// Has the members of a RECT.
+struct Rect {
+  long left;
+  long top;
+  long right;
+  long bottom;
+};
+
+int failures = 0;
+
+void ExpectRect(const char* name, const Rect& actual, const Rect& expected) {
+  if (actual.left == expected.left && actual.top == expected.top &&
+      actual.right == expected.right && actual.bottom == expected.bottom) {
+    return;
+  }
+  std::fprintf(stderr,
+               "%s: expected {%ld, %ld, %ld, %ld}, got {%ld, %ld, %ld, %ld}\n",
+               name, expected.left, expected.top, expected.right,
+               expected.bottom, actual.left, actual.top, actual.right,
+               actual.bottom);
+  failures++;
+}
+
+void ExpectAspectRatio(const char* name,
+                       int edge,
+                       double aspect_ratio,
+                       Rect rect,
+                       const Rect& expected) {
+  sizing::ApplyAspectRatio(edge, aspect_ratio, &rect);
+  ExpectRect(name, rect, expected);
+}
+
+// Uses increments of 20x10 over a base size of 100x50, with a frame of
+// 10x30.
+void ExpectResizeIncrements(const char* name,
+                            int edge,
+                            Rect rect,
+                            const Rect& expected) {
+  sizing::ApplyResizeIncrements(edge, 20, 10, 100, 50, 10, 30, &rect);
+  ExpectRect(name, rect, expected);
+}
+
+void TestAspectRatio() {
+  // 400x300 with a ratio of 2. Dragging a left or right edge keeps the
+  // width, the others keep the height.
+  const Rect rect = {100, 100, 500, 400};
+  ExpectAspectRatio("aspect left", sizing::kSizingLeft, 2, rect,
+                    {100, 200, 500, 400});
+  ExpectAspectRatio("aspect right", sizing::kSizingRight, 2, rect,
+                    {100, 100, 500, 300});
+  ExpectAspectRatio("aspect top", sizing::kSizingTop, 2, rect,
+                    {100, 100, 700, 400});
+  ExpectAspectRatio("aspect top left", sizing::kSizingTopLeft, 2, rect,
+                    {100, 200, 500, 400});
+  ExpectAspectRatio("aspect top right", sizing::kSizingTopRight, 2, rect,
+                    {100, 100, 700, 400});
+  ExpectAspectRatio("aspect bottom", sizing::kSizingBottom, 2, rect,
+                    {100, 100, 700, 400});
+  ExpectAspectRatio("aspect bottom left", sizing::kSizingBottomLeft, 2, rect,
+                    {100, 100, 500, 300});
+  ExpectAspectRatio("aspect bottom right", sizing::kSizingBottomRight, 2,
+                    rect, {100, 100, 700, 400});
+
+  ExpectAspectRatio("aspect zero", sizing::kSizingRight, 0, rect, rect);
+  ExpectAspectRatio("aspect negative", sizing::kSizingRight, -1, rect, rect);
+}
+
+void TestResizeIncrements() {
+  // A client area of 147x76 rounds to 100 + 2 * 20 by 50 + 3 * 10, which is
+  // a window of 150x110. Only the dragged edges move, and a side edge only
+  // steps its own axis.
+  const Rect rect = {200, 100, 357, 206};
+  ExpectResizeIncrements("increments left", sizing::kSizingLeft, rect,
+                         {207, 100, 357, 206});
+  ExpectResizeIncrements("increments right", sizing::kSizingRight, rect,
+                         {200, 100, 350, 206});
+  ExpectResizeIncrements("increments top", sizing::kSizingTop, rect,
+                         {200, 96, 357, 206});
+  ExpectResizeIncrements("increments top left", sizing::kSizingTopLeft, rect,
+                         {207, 96, 357, 206});
+  ExpectResizeIncrements("increments top right", sizing::kSizingTopRight,
+                         rect, {200, 96, 350, 206});
+  ExpectResizeIncrements("increments bottom", sizing::kSizingBottom, rect,
+                         {200, 100, 357, 210});
+  ExpectResizeIncrements("increments bottom left", sizing::kSizingBottomLeft,
+                         rect, {207, 100, 357, 210});
+  ExpectResizeIncrements("increments bottom right",
+                         sizing::kSizingBottomRight, rect,
+                         {200, 100, 350, 210});
+
+  // Smaller than the base size.
+  ExpectResizeIncrements("increments below base", sizing::kSizingRight,
+                         {0, 0, 60, 40}, {0, 0, 110, 40});
+  ExpectResizeIncrements("increments below base corner",
+                         sizing::kSizingBottomRight, {0, 0, 60, 40},
+                         {0, 0, 110, 80});
+
+  Rect unchanged = rect;
+  sizing::ApplyResizeIncrements(sizing::kSizingRight, 0, 10, 100, 50, 10, 30,
+                                &unchanged);
+  ExpectRect("increments zero width", unchanged, rect);
+  sizing::ApplyResizeIncrements(sizing::kSizingRight, 20, 0, 100, 50, 10, 30,
+                                &unchanged);
+  ExpectRect("increments zero height", unchanged, rect);
+}
+
+}  // namespace
+
+int main() {
+  TestAspectRatio();
+  TestResizeIncrements();
+  if (failures > 0) {
+    std::fprintf(stderr, "%d failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
@@ -13,9 +13,17 @@
 
 #include <dwmapi.h>
 #include <codecvt>
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <sstream>
+#include <vector>
+
+#include "window_sizing.h"
+
+static_assert(sizing::kSizingLeft == WMSZ_LEFT &&
+                  sizing::kSizingBottomRight == WMSZ_BOTTOMRIGHT,
+              "SizingEdge must match the WMSZ_* constants");
 
 #pragma comment(lib, "dwmapi.lib")
 #pragma comment(lib, "user32.lib")
@@ -62,6 +70,35 @@ const flutter::EncodableValue* ValueOrNull(const flutter::EncodableMap& map,
   return &(it->second);
 }
 
+BOOL CALLBACK CollectMonitor(HMONITOR monitor, HDC, LPRECT, LPARAM data) {
+  reinterpret_cast<std::vector<HMONITOR>*>(data)->push_back(monitor);
+  return TRUE;
+}
+
+std::vector<HMONITOR> GetMonitors() {
+  std::vector<HMONITOR> monitors;
+  EnumDisplayMonitors(nullptr, nullptr, CollectMonitor,
+                      reinterpret_cast<LPARAM>(&monitors));
+  return monitors;
+}
+
+// Returns the offset of the workspace coordinates used by WINDOWPLACEMENT
+// from the screen coordinates, caused by taskbars on the left or top edge
+// of the monitor. Tool windows use screen coordinates.
+POINT GetWorkspaceOffset(HWND hwnd, HMONITOR monitor) {
+  POINT offset = {0, 0};
+  if (GetWindowLong(hwnd, GWL_EXSTYLE) & WS_EX_TOOLWINDOW) {
+    return offset;
+  }
+  MONITORINFO monitor_info = {};
+  monitor_info.cbSize = sizeof(MONITORINFO);
+  if (GetMonitorInfo(monitor, &monitor_info)) {
+    offset.x = monitor_info.rcWork.left - monitor_info.rcMonitor.left;
+    offset.y = monitor_info.rcWork.top - monitor_info.rcMonitor.top;
+  }
+  return offset;
+}
+
 class WindowManager {
  public:
   WindowManager();
@@ -79,6 +116,8 @@ class WindowManager {
   double aspect_ratio_ = 0;
   POINT minimum_size_ = {0, 0};
   POINT maximum_size_ = {-1, -1};
+  POINT resize_increments_ = {0, 0};
+  POINT base_size_ = {0, 0};
   double pixel_ratio_ = 1;
   bool is_resizable_ = true;
   int is_docked_ = 0;
@@ -122,8 +161,13 @@ class WindowManager {
   flutter::EncodableMap WindowManager::GetBounds(
       const flutter::EncodableMap& args);
   void WindowManager::SetBounds(const flutter::EncodableMap& args);
+  flutter::EncodableMap WindowManager::GetPlacement(
+      const flutter::EncodableMap& args);
+  void WindowManager::SetPlacement(const flutter::EncodableMap& args);
   void WindowManager::SetMinimumSize(const flutter::EncodableMap& args);
   void WindowManager::SetMaximumSize(const flutter::EncodableMap& args);
+  void WindowManager::SetResizeIncrements(const flutter::EncodableMap& args);
+  void WindowManager::ApplyResizeIncrements(WPARAM edge, RECT* rect);
   bool WindowManager::IsResizable();
   void WindowManager::SetResizable(const flutter::EncodableMap& args);
   bool WindowManager::IsMinimizable();
@@ -161,7 +205,9 @@ class WindowManager {
   RECT g_frame_before_fullscreen;
   bool g_maximized_before_fullscreen;
   LONG g_style_before_fullscreen;
+#ifdef WINDOW_MANAGER_ENABLE_TASKBAR
   ITaskbarList3* taskbar_ = nullptr;
+#endif
   double GetDpiForHwnd(HWND hWnd);
   BOOL WindowManager::RegisterAccessBar(HWND hwnd, BOOL fRegister);
   void PASCAL WindowManager::AppBarQuerySetPos(HWND hwnd,
@@ -225,8 +271,10 @@ void WindowManager::SetAsFrameless() {
 }
 
 void WindowManager::WaitUntilReadyToShow() {
+#ifdef WINDOW_MANAGER_ENABLE_TASKBAR
   ::CoCreateInstance(CLSID_TaskbarList, NULL, CLSCTX_INPROC_SERVER,
                      IID_PPV_ARGS(&taskbar_));
+#endif
 }
 
 void WindowManager::Destroy() {
@@ -365,6 +413,7 @@ void WindowManager::Restore() {
   }
 }
 
+#ifdef WINDOW_MANAGER_ENABLE_DOCKING
 bool WindowManager::IsDockable() {
   return true;
 }
@@ -372,6 +421,7 @@ bool WindowManager::IsDockable() {
 int WindowManager::IsDocked() {
   return is_docked_;
 }
+#endif
 
 double WindowManager::GetDpiForHwnd(HWND hWnd) {
   auto monitor = MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST);
@@ -402,6 +452,7 @@ double WindowManager::GetDpiForHwnd(HWND hWnd) {
   return ((double)newDpiX);
 }
 
+#ifdef WINDOW_MANAGER_ENABLE_DOCKING
 void WindowManager::Dock(const flutter::EncodableMap& args) {
   HWND mainWindow = GetMainWindow();
 
@@ -426,6 +477,7 @@ void WindowManager::Dock(const flutter::EncodableMap& args) {
   // dock window
   DockAccessBar(mainWindow, edge, uw);
 }
+#endif
 
 bool WindowManager::Undock() {
   HWND mainWindow = GetMainWindow();
@@ -530,6 +582,7 @@ BOOL WindowManager::RegisterAccessBar(HWND hwnd, BOOL fRegister) {
   return false;
 }
 
+#ifdef WINDOW_MANAGER_ENABLE_DOCKING
 void WindowManager::DockAccessBar(HWND hwnd, UINT edge, UINT windowWidth) {
   APPBARDATA abd;
   RECT lprc;
@@ -560,6 +613,7 @@ void WindowManager::DockAccessBar(HWND hwnd, UINT edge, UINT windowWidth) {
 
   return;
 }
+#endif
 
 bool WindowManager::IsFullScreen() {
   return g_is_window_fullscreen;
@@ -659,6 +713,7 @@ void WindowManager::SetAspectRatio(const flutter::EncodableMap& args) {
       std::get<double>(args.at(flutter::EncodableValue("aspectRatio")));
 }
 
+#ifdef WINDOW_MANAGER_ENABLE_BACKGROUND_COLOR
 void WindowManager::SetBackgroundColor(const flutter::EncodableMap& args) {
   int backgroundColorA =
       std::get<int>(args.at(flutter::EncodableValue("backgroundColorA")));
@@ -714,6 +769,7 @@ void WindowManager::SetBackgroundColor(const flutter::EncodableMap& args) {
     FreeLibrary(hModule);
   }
 }
+#endif
 
 flutter::EncodableMap WindowManager::GetBounds(
     const flutter::EncodableMap& args) {
@@ -775,6 +831,136 @@ void WindowManager::SetBounds(const flutter::EncodableMap& args) {
   SetWindowPos(hwnd, HWND_TOP, x, y, width, height, uFlags);
 }
 
+flutter::EncodableMap WindowManager::GetPlacement(
+    const flutter::EncodableMap& args) {
+  HWND hwnd = GetMainWindow();
+  double devicePixelRatio =
+      std::get<double>(args.at(flutter::EncodableValue("devicePixelRatio")));
+
+  WINDOWPLACEMENT placement = {};
+  placement.length = sizeof(WINDOWPLACEMENT);
+  GetWindowPlacement(hwnd, &placement);
+
+  RECT rect = placement.rcNormalPosition;
+  HMONITOR monitor = MonitorFromRect(&rect, MONITOR_DEFAULTTONEAREST);
+  POINT offset = GetWorkspaceOffset(hwnd, monitor);
+  OffsetRect(&rect, offset.x, offset.y);
+
+  std::string state = "normal";
+  if (placement.showCmd == SW_SHOWMINIMIZED) {
+    state = "minimized";
+  } else if (g_is_window_fullscreen) {
+    state = "fullScreen";
+    // Entering full screen from the normal state resizes the window without
+    // changing its show state, which overwrites rcNormalPosition.
+    if (!g_maximized_before_fullscreen) {
+      rect = g_frame_before_fullscreen;
+    }
+  } else if (placement.showCmd == SW_SHOWMAXIMIZED) {
+    state = "maximized";
+  }
+
+  std::vector<HMONITOR> monitors = GetMonitors();
+  int monitor_index = -1;
+  for (size_t i = 0; i < monitors.size(); i++) {
+    if (monitors[i] == MonitorFromRect(&rect, MONITOR_DEFAULTTONEAREST)) {
+      monitor_index = static_cast<int>(i);
+    }
+  }
+
+  flutter::EncodableMap resultMap = flutter::EncodableMap();
+  resultMap[flutter::EncodableValue("x")] =
+      flutter::EncodableValue(rect.left / devicePixelRatio);
+  resultMap[flutter::EncodableValue("y")] =
+      flutter::EncodableValue(rect.top / devicePixelRatio);
+  resultMap[flutter::EncodableValue("width")] =
+      flutter::EncodableValue((rect.right - rect.left) / devicePixelRatio);
+  resultMap[flutter::EncodableValue("height")] =
+      flutter::EncodableValue((rect.bottom - rect.top) / devicePixelRatio);
+  resultMap[flutter::EncodableValue("state")] = flutter::EncodableValue(state);
+  resultMap[flutter::EncodableValue("monitor")] =
+      flutter::EncodableValue(monitor_index);
+  return resultMap;
+}
+
+// Applies the normal bounds and the show state with a single
+// SetWindowPlacement. Windows has no API for virtual desktops that works
+// on the window of the own process, so the workspace is ignored.
+void WindowManager::SetPlacement(const flutter::EncodableMap& args) {
+  HWND hwnd = GetMainWindow();
+  double devicePixelRatio =
+      std::get<double>(args.at(flutter::EncodableValue("devicePixelRatio")));
+  double x = std::get<double>(args.at(flutter::EncodableValue("x")));
+  double y = std::get<double>(args.at(flutter::EncodableValue("y")));
+  double width = std::get<double>(args.at(flutter::EncodableValue("width")));
+  double height = std::get<double>(args.at(flutter::EncodableValue("height")));
+  std::string state =
+      std::get<std::string>(args.at(flutter::EncodableValue("state")));
+  auto* null_or_monitor = std::get_if<int>(ValueOrNull(args, "monitor"));
+
+  RECT rect;
+  rect.left = static_cast<LONG>(x * devicePixelRatio);
+  rect.top = static_cast<LONG>(y * devicePixelRatio);
+  rect.right = rect.left + static_cast<LONG>(width * devicePixelRatio);
+  rect.bottom = rect.top + static_cast<LONG>(height * devicePixelRatio);
+
+  // Keep the window reachable when the monitor it was saved on is gone.
+  HMONITOR monitor = MonitorFromRect(&rect, MONITOR_DEFAULTTONULL);
+  if (monitor == nullptr) {
+    std::vector<HMONITOR> monitors = GetMonitors();
+    if (null_or_monitor != nullptr && *null_or_monitor >= 0 &&
+        *null_or_monitor < static_cast<int>(monitors.size())) {
+      monitor = monitors[*null_or_monitor];
+    } else {
+      monitor = MonitorFromPoint(POINT{0, 0}, MONITOR_DEFAULTTOPRIMARY);
+    }
+    MONITORINFO monitor_info = {};
+    monitor_info.cbSize = sizeof(MONITORINFO);
+    GetMonitorInfo(monitor, &monitor_info);
+    const RECT& work = monitor_info.rcWork;
+    LONG rect_width =
+        (std::min)(rect.right - rect.left, work.right - work.left);
+    LONG rect_height =
+        (std::min)(rect.bottom - rect.top, work.bottom - work.top);
+    rect.left = work.left + (work.right - work.left - rect_width) / 2;
+    rect.top = work.top + (work.bottom - work.top - rect_height) / 2;
+    rect.right = rect.left + rect_width;
+    rect.bottom = rect.top + rect_height;
+  }
+
+  if (g_is_window_fullscreen) {
+    SetFullScreen(flutter::EncodableMap{
+        {flutter::EncodableValue("isFullScreen"),
+         flutter::EncodableValue(false)}});
+  }
+
+  POINT offset = GetWorkspaceOffset(hwnd, monitor);
+  OffsetRect(&rect, -offset.x, -offset.y);
+
+  WINDOWPLACEMENT placement = {};
+  placement.length = sizeof(WINDOWPLACEMENT);
+  GetWindowPlacement(hwnd, &placement);
+  placement.flags = 0;
+  placement.rcNormalPosition = rect;
+  if (state == "maximized") {
+    placement.showCmd = SW_SHOWMAXIMIZED;
+  } else if (state == "minimized") {
+    placement.showCmd = SW_SHOWMINIMIZED;
+  } else if (IsWindowVisible(hwnd)) {
+    placement.showCmd = SW_SHOWNORMAL;
+  } else {
+    // Only move a hidden window, it is shown by show().
+    placement.showCmd = SW_HIDE;
+  }
+  SetWindowPlacement(hwnd, &placement);
+
+  if (state == "fullScreen") {
+    SetFullScreen(flutter::EncodableMap{
+        {flutter::EncodableValue("isFullScreen"),
+         flutter::EncodableValue(true)}});
+  }
+}
+
 void WindowManager::SetMinimumSize(const flutter::EncodableMap& args) {
   double devicePixelRatio =
       std::get<double>(args.at(flutter::EncodableValue("devicePixelRatio")));
@@ -805,6 +991,44 @@ void WindowManager::SetMaximumSize(const flutter::EncodableMap& args) {
   }
 }
 
+void WindowManager::SetResizeIncrements(const flutter::EncodableMap& args) {
+  double devicePixelRatio =
+      std::get<double>(args.at(flutter::EncodableValue("devicePixelRatio")));
+  double width = std::get<double>(args.at(flutter::EncodableValue("width")));
+  double height = std::get<double>(args.at(flutter::EncodableValue("height")));
+  double baseWidth =
+      std::get<double>(args.at(flutter::EncodableValue("baseWidth")));
+  double baseHeight =
+      std::get<double>(args.at(flutter::EncodableValue("baseHeight")));
+
+  if (width > 0 && height > 0) {
+    resize_increments_.x = static_cast<LONG>(width * devicePixelRatio);
+    resize_increments_.y = static_cast<LONG>(height * devicePixelRatio);
+    base_size_.x = static_cast<LONG>(baseWidth * devicePixelRatio);
+    base_size_.y = static_cast<LONG>(baseHeight * devicePixelRatio);
+  } else {
+    resize_increments_ = {0, 0};
+    base_size_ = {0, 0};
+  }
+}
+
+void WindowManager::ApplyResizeIncrements(WPARAM edge, RECT* rect) {
+  if (resize_increments_.x <= 0 || resize_increments_.y <= 0)
+    return;
+
+  HWND hWnd = GetMainWindow();
+  RECT window_rect, client_rect;
+  GetWindowRect(hWnd, &window_rect);
+  GetClientRect(hWnd, &client_rect);
+  LONG frame_width = (window_rect.right - window_rect.left) - client_rect.right;
+  LONG frame_height =
+      (window_rect.bottom - window_rect.top) - client_rect.bottom;
+
+  sizing::ApplyResizeIncrements(
+      static_cast<int>(edge), resize_increments_.x, resize_increments_.y,
+      base_size_.x, base_size_.y, frame_width, frame_height, rect);
+}
+
 bool WindowManager::IsResizable() {
   return is_resizable_;
 }
@@ -942,6 +1166,7 @@ int WindowManager::GetTitleBarHeight() {
   return height;
 }
 
+#ifdef WINDOW_MANAGER_ENABLE_TASKBAR
 bool WindowManager::IsSkipTaskbar() {
   return is_skip_taskbar_;
 }
@@ -985,6 +1210,7 @@ void WindowManager::SetProgressBar(const flutter::EncodableMap& args) {
                                static_cast<int32_t>(100));
   }
 }
+#endif
 
 void WindowManager::SetIcon(const flutter::EncodableMap& args) {
   std::string iconPath =
@@ -1037,6 +1263,7 @@ void WindowManager::SetOpacity(const flutter::EncodableMap& args) {
                              0x02);
 }
 
+#ifdef WINDOW_MANAGER_ENABLE_BRIGHTNESS
 void WindowManager::SetBrightness(const flutter::EncodableMap& args) {
   DWORD light_mode;
   DWORD light_mode_size = sizeof(light_mode);
@@ -1054,6 +1281,7 @@ void WindowManager::SetBrightness(const flutter::EncodableMap& args) {
                           &enable_dark_mode, sizeof(enable_dark_mode));
   }
 }
+#endif
 
 void WindowManager::SetIgnoreMouseEvents(const flutter::EncodableMap& args) {
   bool ignore = std::get<bool>(args.at(flutter::EncodableValue("ignore")));
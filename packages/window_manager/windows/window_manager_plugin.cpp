@@ -8,6 +8,8 @@
 #include <flutter/standard_method_codec.h>
 
 #include <codecvt>
+#include <cstring>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <sstream>
@@ -31,6 +33,175 @@ bool IsWindows11OrGreater() {
   return dwBuild < 22000;
 }
 
+// The handler of a method. `arguments` is null if the call has none.
+typedef void (*MethodHandler)(WindowManager* window_manager,
+                              const flutter::EncodableValue* arguments,
+                              flutter::MethodResult<flutter::EncodableValue>*
+                                  result);
+
+// Calls `method` and returns true.
+template <void (WindowManager::*method)()>
+void Call(WindowManager* window_manager,
+          const flutter::EncodableValue* arguments,
+          flutter::MethodResult<flutter::EncodableValue>* result) {
+  (window_manager->*method)();
+  result->Success(flutter::EncodableValue(true));
+}
+
+// Calls `method` with the argument map and returns true.
+template <void (WindowManager::*method)(const flutter::EncodableMap&)>
+void CallWithArgs(WindowManager* window_manager,
+                  const flutter::EncodableValue* arguments,
+                  flutter::MethodResult<flutter::EncodableValue>* result) {
+  (window_manager->*method)(std::get<flutter::EncodableMap>(*arguments));
+  result->Success(flutter::EncodableValue(true));
+}
+
+// Returns the value of `method`.
+template <typename T, T (WindowManager::*method)()>
+void Get(WindowManager* window_manager,
+         const flutter::EncodableValue* arguments,
+         flutter::MethodResult<flutter::EncodableValue>* result) {
+  result->Success(flutter::EncodableValue((window_manager->*method)()));
+}
+
+// Returns the value of `method` called with the argument map.
+template <typename T, T (WindowManager::*method)(const flutter::EncodableMap&)>
+void GetWithArgs(WindowManager* window_manager,
+                 const flutter::EncodableValue* arguments,
+                 flutter::MethodResult<flutter::EncodableValue>* result) {
+  result->Success(flutter::EncodableValue(
+      (window_manager->*method)(std::get<flutter::EncodableMap>(*arguments))));
+}
+
+void GetId(WindowManager* window_manager,
+           const flutter::EncodableValue* arguments,
+           flutter::MethodResult<flutter::EncodableValue>* result) {
+  result->Success(flutter::EncodableValue(
+      reinterpret_cast<__int64>(window_manager->GetMainWindow())));
+}
+
+struct MethodEntry {
+  const char* name;
+  MethodHandler handler;
+};
+
+// Sorted by name for FindMethodEntry. Methods of disabled features are left
+// out, so calls to them return not implemented.
+constexpr MethodEntry kMethodHandlers[] = {
+    {"blur", Call<&WindowManager::Blur>},
+    {"close", Call<&WindowManager::Close>},
+    {"destroy", Call<&WindowManager::Destroy>},
+#ifdef WINDOW_MANAGER_ENABLE_DOCKING
+    {"dock", CallWithArgs<&WindowManager::Dock>},
+#endif
+    {"focus", Call<&WindowManager::Focus>},
+    {"getBounds",
+     GetWithArgs<flutter::EncodableMap, &WindowManager::GetBounds>},
+    {"getId", GetId},
+    {"getOpacity", Get<double, &WindowManager::GetOpacity>},
+    {"getPlacement",
+     GetWithArgs<flutter::EncodableMap, &WindowManager::GetPlacement>},
+    {"getTitle", Get<std::string, &WindowManager::GetTitle>},
+    {"getTitleBarHeight", Get<int, &WindowManager::GetTitleBarHeight>},
+    {"hasShadow", Get<bool, &WindowManager::HasShadow>},
+    {"hide", Call<&WindowManager::Hide>},
+    {"isAlwaysOnBottom", Get<bool, &WindowManager::IsAlwaysOnBottom>},
+    {"isAlwaysOnTop", Get<bool, &WindowManager::IsAlwaysOnTop>},
+    {"isClosable", Get<bool, &WindowManager::IsClosable>},
+#ifdef WINDOW_MANAGER_ENABLE_DOCKING
+    {"isDockable", Get<bool, &WindowManager::IsDockable>},
+    {"isDocked", Get<int, &WindowManager::IsDocked>},
+#endif
+    {"isFocused", Get<bool, &WindowManager::IsFocused>},
+    {"isFullScreen", Get<bool, &WindowManager::IsFullScreen>},
+    {"isMaximizable", Get<bool, &WindowManager::IsMaximizable>},
+    {"isMaximized", Get<bool, &WindowManager::IsMaximized>},
+    {"isMinimizable", Get<bool, &WindowManager::IsMinimizable>},
+    {"isMinimized", Get<bool, &WindowManager::IsMinimized>},
+    {"isPreventClose", Get<bool, &WindowManager::IsPreventClose>},
+    {"isResizable", Get<bool, &WindowManager::IsResizable>},
+#ifdef WINDOW_MANAGER_ENABLE_TASKBAR
+    {"isSkipTaskbar", Get<bool, &WindowManager::IsSkipTaskbar>},
+#endif
+    {"isVisible", Get<bool, &WindowManager::IsVisible>},
+    {"maximize", CallWithArgs<&WindowManager::Maximize>},
+    {"minimize", Call<&WindowManager::Minimize>},
+    {"popUpWindowMenu", CallWithArgs<&WindowManager::PopUpWindowMenu>},
+    {"restore", Call<&WindowManager::Restore>},
+    {"setAlwaysOnBottom", CallWithArgs<&WindowManager::SetAlwaysOnBottom>},
+    {"setAlwaysOnTop", CallWithArgs<&WindowManager::SetAlwaysOnTop>},
+    {"setAsFrameless", Call<&WindowManager::SetAsFrameless>},
+    {"setAspectRatio", CallWithArgs<&WindowManager::SetAspectRatio>},
+#ifdef WINDOW_MANAGER_ENABLE_BACKGROUND_COLOR
+    {"setBackgroundColor", CallWithArgs<&WindowManager::SetBackgroundColor>},
+#endif
+    {"setBounds", CallWithArgs<&WindowManager::SetBounds>},
+#ifdef WINDOW_MANAGER_ENABLE_BRIGHTNESS
+    {"setBrightness", CallWithArgs<&WindowManager::SetBrightness>},
+#endif
+    {"setClosable", CallWithArgs<&WindowManager::SetClosable>},
+    {"setFullScreen", CallWithArgs<&WindowManager::SetFullScreen>},
+    {"setHasShadow", CallWithArgs<&WindowManager::SetHasShadow>},
+    {"setIcon", CallWithArgs<&WindowManager::SetIcon>},
+    {"setIgnoreMouseEvents",
+     CallWithArgs<&WindowManager::SetIgnoreMouseEvents>},
+    {"setMaximizable", CallWithArgs<&WindowManager::SetMaximizable>},
+    {"setMaximumSize", CallWithArgs<&WindowManager::SetMaximumSize>},
+    {"setMinimizable", CallWithArgs<&WindowManager::SetMinimizable>},
+    {"setMinimumSize", CallWithArgs<&WindowManager::SetMinimumSize>},
+    {"setOpacity", CallWithArgs<&WindowManager::SetOpacity>},
+    {"setPlacement", CallWithArgs<&WindowManager::SetPlacement>},
+    {"setPreventClose", CallWithArgs<&WindowManager::SetPreventClose>},
+#ifdef WINDOW_MANAGER_ENABLE_TASKBAR
+    {"setProgressBar", CallWithArgs<&WindowManager::SetProgressBar>},
+#endif
+    {"setResizable", CallWithArgs<&WindowManager::SetResizable>},
+    {"setResizeIncrements", CallWithArgs<&WindowManager::SetResizeIncrements>},
+#ifdef WINDOW_MANAGER_ENABLE_TASKBAR
+    {"setSkipTaskbar", CallWithArgs<&WindowManager::SetSkipTaskbar>},
+#endif
+    {"setTitle", CallWithArgs<&WindowManager::SetTitle>},
+    {"setTitleBarStyle", CallWithArgs<&WindowManager::SetTitleBarStyle>},
+    {"show", Call<&WindowManager::Show>},
+    {"startDragging", Call<&WindowManager::StartDragging>},
+    {"startResizing", CallWithArgs<&WindowManager::StartResizing>},
+#ifdef WINDOW_MANAGER_ENABLE_DOCKING
+    {"undock", Get<bool, &WindowManager::Undock>},
+#endif
+    {"unmaximize", Call<&WindowManager::Unmaximize>},
+    {"waitUntilReadyToShow", Call<&WindowManager::WaitUntilReadyToShow>},
+};
+
+constexpr int CompareMethodNames(const char* a, const char* b) {
+  return (*a != *b || *a == '\0') ? *a - *b : CompareMethodNames(a + 1, b + 1);
+}
+
+constexpr bool IsSortedByName(const MethodEntry* entries, size_t length) {
+  return length < 2 ||
+         (CompareMethodNames(entries[0].name, entries[1].name) < 0 &&
+          IsSortedByName(entries + 1, length - 1));
+}
+
+static_assert(IsSortedByName(kMethodHandlers, std::size(kMethodHandlers)),
+              "kMethodHandlers must be sorted by name");
+
+const MethodEntry* FindMethodEntry(const char* method) {
+  size_t low = 0;
+  size_t high = std::size(kMethodHandlers);
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    int cmp = strcmp(method, kMethodHandlers[mid].name);
+    if (cmp == 0)
+      return &kMethodHandlers[mid];
+    if (cmp < 0)
+      high = mid;
+    else
+      low = mid + 1;
+  }
+  return nullptr;
+}
+
 class WindowManagerPlugin : public flutter::Plugin {
  public:
   static void RegisterWithRegistrar(flutter::PluginRegistrarWindows* registrar);
@@ -231,63 +402,11 @@ std::optional<LRESULT> WindowManagerPlugin::HandleWindowProc(HWND hWnd,
     window_manager->is_resizing_ = true;
     _EmitEvent("resize");
 
-    if (window_manager->aspect_ratio_ > 0) {
-      RECT* rect = (LPRECT)lParam;
-
-      double aspect_ratio = window_manager->aspect_ratio_;
-
-      int new_width = static_cast<int>(rect->right - rect->left);
-      int new_height = static_cast<int>(rect->bottom - rect->top);
-
-      bool is_resizing_horizontally =
-          wParam == WMSZ_LEFT || wParam == WMSZ_RIGHT ||
-          wParam == WMSZ_TOPLEFT || wParam == WMSZ_BOTTOMLEFT;
-
-      if (is_resizing_horizontally) {
-        new_height = static_cast<int>(new_width / aspect_ratio);
-      } else {
-        new_width = static_cast<int>(new_height * aspect_ratio);
-      }
-
-      int left = rect->left;
-      int top = rect->top;
-      int right = rect->right;
-      int bottom = rect->bottom;
-
-      switch (wParam) {
-        case WMSZ_RIGHT:
-        case WMSZ_BOTTOM:
-          right = new_width + left;
-          bottom = top + new_height;
-          break;
-        case WMSZ_TOP:
-          right = new_width + left;
-          top = bottom - new_height;
-          break;
-        case WMSZ_LEFT:
-        case WMSZ_TOPLEFT:
-          left = right - new_width;
-          top = bottom - new_height;
-          break;
-        case WMSZ_TOPRIGHT:
-          right = left + new_width;
-          top = bottom - new_height;
-          break;
-        case WMSZ_BOTTOMLEFT:
-          left = right - new_width;
-          bottom = top + new_height;
-          break;
-        case WMSZ_BOTTOMRIGHT:
-          right = left + new_width;
-          bottom = top + new_height;
-          break;
-      }
-
-      rect->left = left;
-      rect->top = top;
-      rect->right = right;
-      rect->bottom = bottom;
-    }
+    sizing::ApplyAspectRatio(static_cast<int>(wParam),
+                             window_manager->aspect_ratio_,
+                             reinterpret_cast<LPRECT>(lParam));
+    window_manager->ApplyResizeIncrements(wParam,
+                                          reinterpret_cast<LPRECT>(lParam));
   } else if (message == WM_SIZE) {
     if (window_manager->IsFullScreen() && wParam == SIZE_MAXIMIZED &&
         window_manager->last_state != STATE_FULLSCREEN_ENTERED) {
@@ -342,249 +461,22 @@ std::optional<LRESULT> WindowManagerPlugin::HandleWindowProc(HWND hWnd,
 void WindowManagerPlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue>& method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  std::string method_name = method_call.method_name();
+  const std::string& method_name = method_call.method_name();
 
+  // Needs the registrar, which the method table has no access to.
   if (method_name.compare("ensureInitialized") == 0) {
     window_manager->native_window =
         ::GetAncestor(registrar->GetView()->GetNativeWindow(), GA_ROOT);
     result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("waitUntilReadyToShow") == 0) {
-    window_manager->WaitUntilReadyToShow();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("getId") == 0) {
-    result->Success(flutter::EncodableValue(
-        reinterpret_cast<__int64>(window_manager->GetMainWindow())));
-  } else if (method_name.compare("setAsFrameless") == 0) {
-    window_manager->SetAsFrameless();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("destroy") == 0) {
-    window_manager->Destroy();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("close") == 0) {
-    window_manager->Close();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("isPreventClose") == 0) {
-    auto value = window_manager->IsPreventClose();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setPreventClose") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetPreventClose(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("focus") == 0) {
-    window_manager->Focus();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("blur") == 0) {
-    window_manager->Blur();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("isFocused") == 0) {
-    bool value = window_manager->IsFocused();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("show") == 0) {
-    window_manager->Show();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("hide") == 0) {
-    window_manager->Hide();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("isVisible") == 0) {
-    bool value = window_manager->IsVisible();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("isMaximized") == 0) {
-    bool value = window_manager->IsMaximized();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("maximize") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->Maximize(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("unmaximize") == 0) {
-    window_manager->Unmaximize();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("isMinimized") == 0) {
-    bool value = window_manager->IsMinimized();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("minimize") == 0) {
-    window_manager->Minimize();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("restore") == 0) {
-    window_manager->Restore();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("isDockable") == 0) {
-    bool value = window_manager->IsDockable();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("isDocked") == 0) {
-    int value = window_manager->IsDocked();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("dock") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->Dock(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("undock") == 0) {
-    bool value = window_manager->Undock();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("isFullScreen") == 0) {
-    bool value = window_manager->IsFullScreen();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setFullScreen") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetFullScreen(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("setAspectRatio") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetAspectRatio(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("setBackgroundColor") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetBackgroundColor(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("getBounds") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    flutter::EncodableMap value = window_manager->GetBounds(args);
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setBounds") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetBounds(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("setMinimumSize") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetMinimumSize(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("setMaximumSize") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetMaximumSize(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("isResizable") == 0) {
-    bool value = window_manager->IsResizable();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setResizable") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetResizable(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("isMinimizable") == 0) {
-    bool value = window_manager->IsMinimizable();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setMinimizable") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetMinimizable(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("isMaximizable") == 0) {
-    bool value = window_manager->IsMaximizable();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setMaximizable") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetMaximizable(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("isClosable") == 0) {
-    bool value = window_manager->IsClosable();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setClosable") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetClosable(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("isAlwaysOnTop") == 0) {
-    bool value = window_manager->IsAlwaysOnTop();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setAlwaysOnTop") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetAlwaysOnTop(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("isAlwaysOnBottom") == 0) {
-    bool value = window_manager->IsAlwaysOnBottom();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setAlwaysOnBottom") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetAlwaysOnBottom(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("getTitle") == 0) {
-    std::string value = window_manager->GetTitle();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setTitle") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetTitle(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("setTitleBarStyle") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetTitleBarStyle(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("getTitleBarHeight") == 0) {
-    int value = window_manager->GetTitleBarHeight();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("isSkipTaskbar") == 0) {
-    bool value = window_manager->IsSkipTaskbar();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setSkipTaskbar") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetSkipTaskbar(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("setProgressBar") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetProgressBar(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("setIcon") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetIcon(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("hasShadow") == 0) {
-    bool value = window_manager->HasShadow();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setHasShadow") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetHasShadow(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("getOpacity") == 0) {
-    double value = window_manager->GetOpacity();
-    result->Success(flutter::EncodableValue(value));
-  } else if (method_name.compare("setOpacity") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetOpacity(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("setBrightness") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetBrightness(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("setIgnoreMouseEvents") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->SetIgnoreMouseEvents(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("popUpWindowMenu") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->PopUpWindowMenu(args);
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("startDragging") == 0) {
-    window_manager->StartDragging();
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("startResizing") == 0) {
-    const flutter::EncodableMap& args =
-        std::get<flutter::EncodableMap>(*method_call.arguments());
-    window_manager->StartResizing(args);
-    result->Success(flutter::EncodableValue(true));
-  } else {
+    return;
+  }
+
+  const MethodEntry* entry = FindMethodEntry(method_name.c_str());
+  if (entry == nullptr) {
     result->NotImplemented();
+    return;
   }
+  entry->handler(window_manager, method_call.arguments(), result.get());
 }
 
 }  // namespace
@@ -0,0 +1,121 @@
+#ifndef WINDOW_MANAGER_WINDOW_SIZING_H_
+#define WINDOW_MANAGER_WINDOW_SIZING_H_
+
+#include <algorithm>
+
+// The WM_SIZING math of the plugin. It does not depend on the Win32 API, so
+// that it can also be compiled and exercised outside Windows. `Rect` is a
+// RECT or any struct with left, top, right and bottom members.
+namespace sizing {
+
+// The edge being dragged, with the values of the WMSZ_* constants.
+enum SizingEdge {
+  kSizingLeft = 1,
+  kSizingRight = 2,
+  kSizingTop = 3,
+  kSizingTopLeft = 4,
+  kSizingTopRight = 5,
+  kSizingBottom = 6,
+  kSizingBottomLeft = 7,
+  kSizingBottomRight = 8,
+};
+
+// Adjusts the proposed window `rect` to keep `aspect_ratio`.
+template <typename Rect>
+void ApplyAspectRatio(int edge, double aspect_ratio, Rect* rect) {
+  if (aspect_ratio <= 0)
+    return;
+
+  int new_width = static_cast<int>(rect->right - rect->left);
+  int new_height = static_cast<int>(rect->bottom - rect->top);
+
+  bool is_resizing_horizontally =
+      edge == kSizingLeft || edge == kSizingRight || edge == kSizingTopLeft ||
+      edge == kSizingBottomLeft;
+
+  if (is_resizing_horizontally) {
+    new_height = static_cast<int>(new_width / aspect_ratio);
+  } else {
+    new_width = static_cast<int>(new_height * aspect_ratio);
+  }
+
+  auto left = rect->left;
+  auto top = rect->top;
+  auto right = rect->right;
+  auto bottom = rect->bottom;
+
+  switch (edge) {
+    case kSizingRight:
+    case kSizingBottom:
+      right = new_width + left;
+      bottom = top + new_height;
+      break;
+    case kSizingTop:
+      right = new_width + left;
+      top = bottom - new_height;
+      break;
+    case kSizingLeft:
+    case kSizingTopLeft:
+      left = right - new_width;
+      top = bottom - new_height;
+      break;
+    case kSizingTopRight:
+      right = left + new_width;
+      top = bottom - new_height;
+      break;
+    case kSizingBottomLeft:
+      left = right - new_width;
+      bottom = top + new_height;
+      break;
+    case kSizingBottomRight:
+      right = left + new_width;
+      bottom = top + new_height;
+      break;
+  }
+
+  rect->left = left;
+  rect->top = top;
+  rect->right = right;
+  rect->bottom = bottom;
+}
+
+// Steps the client area of the proposed window `rect` to `base_width` x
+// `base_height` plus a whole number of increments, moving the edge that is
+// being dragged. A side edge only steps its own axis. `frame_width` and
+// `frame_height` are the sizes of the non-client area.
+template <typename Rect>
+void ApplyResizeIncrements(int edge,
+                           long increment_width,
+                           long increment_height,
+                           long base_width,
+                           long base_height,
+                           long frame_width,
+                           long frame_height,
+                           Rect* rect) {
+  if (increment_width <= 0 || increment_height <= 0)
+    return;
+
+  long client_width = rect->right - rect->left - frame_width;
+  long client_height = rect->bottom - rect->top - frame_height;
+  long columns = (std::max)(
+      0L, (client_width - base_width + increment_width / 2) / increment_width);
+  long rows = (std::max)(0L, (client_height - base_height +
+                              increment_height / 2) /
+                                 increment_height);
+  long width = base_width + columns * increment_width + frame_width;
+  long height = base_height + rows * increment_height + frame_height;
+
+  if (edge == kSizingLeft || edge == kSizingTopLeft ||
+      edge == kSizingBottomLeft)
+    rect->left = rect->right - width;
+  else if (edge != kSizingTop && edge != kSizingBottom)
+    rect->right = rect->left + width;
+  if (edge == kSizingTop || edge == kSizingTopLeft || edge == kSizingTopRight)
+    rect->top = rect->bottom - height;
+  else if (edge != kSizingLeft && edge != kSizingRight)
+    rect->bottom = rect->top + height;
+}
+
+}  // namespace sizing
+
+#endif  // WINDOW_MANAGER_WINDOW_SIZING_H_